@@ -0,0 +1,424 @@
+// benchmarks for the GrandUnifiedModel kernels, tracer, snapshot output and frame submission
+// built the same way as GrandUnifiedModel.cpp, results are saved as json so runs can be compared
+
+// includes
+// --------
+
+#define GRAND_UNIFIED_MODEL_NO_MAIN
+#include "GrandUnifiedModel.cpp"
+
+#include <sstream>
+
+// structs
+// -------
+
+struct benchmarkResult // one measured value
+{
+    std::string name;
+    long long   size;  // number of points, or 0 when it doesnt apply
+    double      value;
+    std::string unit;
+};
+
+// benchmark settings
+// ------------------
+
+const double minimumBenchmarkTime = 0.2; // each measurement repeats until it has run for at least this long (secconds)
+
+// function prototypes
+// -------------------
+
+void benchmarkStringUpdates( std::vector<benchmarkResult> &results );
+
+template <precisionMode mode>
+void benchmarkMixedString( const char *name, std::vector<benchmarkResult> &results );
+
+void benchmarkCrankNicolson( std::vector<benchmarkResult> &results );
+
+void benchmarkFieldLines( std::vector<benchmarkResult> &results );
+
+void benchmarkSnapshotOutput( std::vector<benchmarkResult> &results );
+
+void benchmarkSonification( std::vector<benchmarkResult> &results );
+
+void benchmarkSparseUpdates( std::vector<benchmarkResult> &results );
+
+void benchmarkSpectrum( std::vector<benchmarkResult> &results );
+
+void benchmarkFrameSubmission( std::vector<benchmarkResult> &results );
+
+void saveResults( const std::vector<benchmarkResult> &results, const std::string &fileName );
+
+// main
+// ----
+
+int main() {
+    std::vector<benchmarkResult> results;
+    benchmarkStringUpdates( results );
+    benchmarkMixedString<doublePrecision>( "updateMixedString double", results );
+    benchmarkMixedString<floatPrecision>( "updateMixedString float", results );
+    benchmarkMixedString<floatDoubleAccumulation>( "updateMixedString float double arithmetic", results );
+    benchmarkMixedString<floatKahanAccumulation>( "updateMixedString float kahan", results );
+    benchmarkCrankNicolson( results );
+    benchmarkFieldLines( results );
+    benchmarkSnapshotOutput( results );
+    benchmarkSonification( results );
+    benchmarkSparseUpdates( results );
+    benchmarkSpectrum( results );
+    benchmarkFrameSubmission( results );
+    saveResults( results, "BenchmarkResults.json" );
+    return EXIT_SUCCESS;
+}
+
+// functions
+// ---------
+
+void benchmarkStringUpdates( std::vector<benchmarkResult> &results ) {
+    // point updates per second for each update variant from 10^2 to 10^7 points, diagnostics included as the model always gathers them
+    const char *names[3] = { "updateFixedString", "updateFreeString", "updateFreeDispersiveString" };
+    for( int variant = 0; variant < 3; variant++ ) {
+        for( int numberOfPoints = 100; numberOfPoints <= 10000000; numberOfPoints *= 10 ) {
+            // uniform string with a stable time step, the values only need to stay finite
+            std::vector<double> stringVector = createString( numberOfPoints, 3, 1.0 );
+            std::vector<double> velocity( numberOfPoints, 0.0 );
+            std::vector<double> mass( numberOfPoints, 1.0 );
+            std::vector<double> tension( numberOfPoints, 1.0 );
+            const double        deltaLength = 1.0;
+            const double        deltaTime   = 0.5;
+            stringDiagnostics   diagnostics;
+            long long           steps       = 0;
+            auto                start       = std::chrono::steady_clock::now();
+            std::chrono::duration<double> elapsed( 0.0 );
+            while( elapsed.count() < minimumBenchmarkTime || steps < 3 ) {
+                if( variant == 0 ) {
+                    updateFixedString( stringVector, velocity, mass, numberOfPoints, tension, deltaLength, deltaTime, diagnostics );
+                }
+                else if( variant == 1 ) {
+                    updateFreeString( stringVector, velocity, mass, numberOfPoints, tension, deltaLength, deltaTime, diagnostics );
+                }
+                else {
+                    updateFreeDispersiveString( stringVector, velocity, mass, numberOfPoints, tension, deltaLength, deltaTime, 1.0, diagnostics );
+                }
+                steps += 1;
+                elapsed = std::chrono::steady_clock::now() - start;
+            }
+            double pointUpdates = static_cast<double>( steps ) * numberOfPoints / elapsed.count();
+            results.push_back( { names[variant], numberOfPoints, pointUpdates, "point updates/s" } );
+            std::cout << std::format( "{} {}: {:.3e} point updates/s", names[variant], numberOfPoints, pointUpdates ) << std::endl;
+        }
+    }
+}
+
+template <precisionMode mode>
+void benchmarkMixedString( const char *name, std::vector<benchmarkResult> &results ) {
+    // the in place kernel at each storage precision, the double one is the baseline for what float storage saves
+    typedef storageType<mode> real;
+    for( int numberOfPoints = 100; numberOfPoints <= 10000000; numberOfPoints *= 10 ) {
+        std::vector<double>           initialString = createString( numberOfPoints, 3, 1.0 );
+        std::vector<real>             stringVector( initialString.begin(), initialString.end() );
+        std::vector<real>             velocity( numberOfPoints, real( 0 ) );
+        std::vector<real>             compensation( numberOfPoints, real( 0 ) );
+        std::vector<real>             coefficient( numberOfPoints, real( 1 ) );
+        std::vector<real>             weight( numberOfPoints, real( 1 ) );
+        stringDiagnostics             diagnostics;
+        long long                     steps = 0;
+        auto                          start = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed( 0.0 );
+        while( elapsed.count() < minimumBenchmarkTime || steps < 3 ) {
+            updateMixedString<mode>( dampedEnds, stringVector, velocity, compensation, coefficient, weight, numberOfPoints, 0.5, 1.0, diagnostics );
+            steps += 1;
+            elapsed = std::chrono::steady_clock::now() - start;
+        }
+        double pointUpdates = static_cast<double>( steps ) * numberOfPoints / elapsed.count();
+        results.push_back( { name, numberOfPoints, pointUpdates, "point updates/s" } );
+        std::cout << std::format( "{} {}: {:.3e} point updates/s", name, numberOfPoints, pointUpdates ) << std::endl;
+    }
+}
+
+void benchmarkCrankNicolson( std::vector<benchmarkResult> &results ) {
+    // implicit step with the factorisation cached, a step costs more than an explicit one but can be far longer
+    for( int numberOfPoints = 100; numberOfPoints <= 10000000; numberOfPoints *= 10 ) {
+        std::vector<double>           stringVector = createString( numberOfPoints, 3, 1.0 );
+        std::vector<double>           velocity( numberOfPoints, 0.0 );
+        std::vector<double>           mass( numberOfPoints, 1.0 );
+        std::vector<double>           tension( numberOfPoints, 1.0 );
+        crankNicolsonOperator         implicitOperator;
+        stringDiagnostics             diagnostics;
+        auto                          start = std::chrono::steady_clock::now();
+        factoriseCrankNicolson( implicitOperator, dampedEnds, mass, numberOfPoints, tension, 1.0, 50.0, 1.0 );
+        std::chrono::duration<double> factoriseTime = std::chrono::steady_clock::now() - start;
+        long long                     steps         = 0;
+        std::chrono::duration<double> elapsed( 0.0 );
+        start = std::chrono::steady_clock::now();
+        while( elapsed.count() < minimumBenchmarkTime || steps < 3 ) {
+            updateCrankNicolsonString( implicitOperator, stringVector, velocity, mass, numberOfPoints, tension, 1.0, diagnostics );
+            steps += 1;
+            elapsed = std::chrono::steady_clock::now() - start;
+        }
+        double pointUpdates = static_cast<double>( steps ) * numberOfPoints / elapsed.count();
+        results.push_back( { "factoriseCrankNicolson", numberOfPoints, factoriseTime.count(), "s" } );
+        results.push_back( { "updateCrankNicolsonString", numberOfPoints, pointUpdates, "point updates/s" } );
+        std::cout << std::format( "updateCrankNicolsonString {}: {:.3e} point updates/s, factorised in {:.3e}s", numberOfPoints, pointUpdates, factoriseTime.count() ) << std::endl;
+    }
+}
+
+void benchmarkFieldLines( std::vector<benchmarkResult> &results ) {
+    // time to trace a field line at each latitude, and how fast tension and mass are filled in along it
+    const int numberOfPoints = 100001;
+    for( int latitudeDegrees = 50; latitudeDegrees <= 80; latitudeDegrees += 10 ) {
+        const double      latitude = -latitudeDegrees * std::numbers::pi / 180.0;
+        std::vector<vec3> worldPoints;
+        auto              start = std::chrono::steady_clock::now();
+        lengthOfMagneticFieldLine( latitude, numberOfPoints, worldPoints );
+        std::chrono::duration<double> traceTime = std::chrono::steady_clock::now() - start;
+        results.push_back( { std::format( "lengthOfMagneticFieldLine {} degrees", latitudeDegrees ), numberOfPoints, traceTime.count(), "s" } );
+
+        std::vector<double> tension( numberOfPoints, 0.0 );
+        std::vector<double> mass( numberOfPoints, 0.0 );
+        long long           calls = 0;
+        start                     = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed( 0.0 );
+        while( elapsed.count() < minimumBenchmarkTime ) {
+            updateTensionMass( numberOfPoints, worldPoints, latitude, tension, mass );
+            calls += 1;
+            elapsed = std::chrono::steady_clock::now() - start;
+        }
+        double pointsPerSecond = static_cast<double>( calls ) * numberOfPoints / elapsed.count();
+        results.push_back( { std::format( "updateTensionMass {} degrees", latitudeDegrees ), numberOfPoints, pointsPerSecond, "points/s" } );
+        std::cout << std::format( "field line {} degrees: traced in {:.3f}s, {:.3e} tension/mass points/s", latitudeDegrees, traceTime.count(), pointsPerSecond ) << std::endl;
+    }
+}
+
+void benchmarkSnapshotOutput( std::vector<benchmarkResult> &results ) {
+    // a full snapshot buffer written as the tab separated text the model saves, and as raw doubles for comparison
+    for( int numberOfPoints = 1001; numberOfPoints <= 100001; numberOfPoints = ( numberOfPoints - 1 ) * 10 + 1 ) {
+        std::queue<bufferData> buffer;
+        std::vector<double>    stringVector = createString( numberOfPoints, 3, 1.0 );
+        for( int i = 0; i < 10; i++ ) {
+            pushToBuffer( buffer, stringVector, i );
+        }
+        const std::string fileName = "../../data/BenchmarkSnapshot.dat";
+
+        // text, writeToFile reports every save so its output is hidden here
+        std::ofstream      text( fileName );
+        std::ostringstream silenced;
+        std::streambuf    *console = std::cout.rdbuf( silenced.rdbuf() );
+        auto               start   = std::chrono::steady_clock::now();
+        writeToFile( buffer, text, 1.0 );
+        text.flush();
+        std::chrono::duration<double> textTime = std::chrono::steady_clock::now() - start;
+        std::cout.rdbuf( console );
+        double textBytes = static_cast<double>( text.tellp() );
+        text.close();
+
+        // binary
+        std::ofstream          binary( fileName, std::ios::binary );
+        std::queue<bufferData> frames = buffer;
+        start                         = std::chrono::steady_clock::now();
+        for( ; !frames.empty(); frames.pop() ) {
+            binary.write( reinterpret_cast<const char *>( &frames.front().time ), sizeof( double ) );
+            binary.write( reinterpret_cast<const char *>( frames.front().string.data() ), numberOfPoints * sizeof( double ) );
+        }
+        binary.flush();
+        std::chrono::duration<double> binaryTime = std::chrono::steady_clock::now() - start;
+        double                        binaryBytes = static_cast<double>( binary.tellp() );
+        binary.close();
+        std::filesystem::remove( fileName );
+
+        results.push_back( { "snapshot text", numberOfPoints, textBytes / 1e6 / textTime.count(), "MB/s" } );
+        results.push_back( { "snapshot binary", numberOfPoints, binaryBytes / 1e6 / binaryTime.count(), "MB/s" } );
+        std::cout << std::format( "snapshot {}: text {:.1f} MB/s, binary {:.1f} MB/s", numberOfPoints, textBytes / 1e6 / textTime.count(), binaryBytes / 1e6 / binaryTime.count() ) << std::endl;
+    }
+}
+
+void benchmarkSonification( std::vector<benchmarkResult> &results ) {
+    // whole headless jobs writing 48 kHz audio from two pickups, above 1 means the audio is made faster than it plays
+    for( int numberOfPoints : { 101, 1001 } ) {
+        scenario run         = defaultScenario();
+        run.name             = "BenchmarkSonification";
+        run.numberOfPoints   = numberOfPoints;
+        run.boundary         = fixedEnds;
+        run.scheme           = crankNicolsonScheme;
+        run.deltaTime        = 1.0;
+        run.endTime          = 5.0 * run.audioSpeedUp;
+        run.snapshotInterval = run.endTime;
+        run.pickups          = { 0.1, 0.9 };
+        jobResult result;
+        runJob( run, result );
+        std::filesystem::remove_all( run.outputDirectory + "/" + run.name );
+        const double realTimeFactor = result.simulatedTime / run.audioSpeedUp / result.wallTime;
+        results.push_back( { "sonification", numberOfPoints, realTimeFactor, "audio s/s" } );
+        std::cout << std::format( "sonification {}: {:.1f}x real time", numberOfPoints, realTimeFactor ) << std::endl;
+    }
+}
+
+void benchmarkSparseUpdates( std::vector<benchmarkResult> &results ) {
+    // a narrow pulse on a long string, the early time a localised disturbance spends in a few blocks
+    std::vector<vec3> worldPoints;
+    const double      length       = lengthOfMagneticFieldLine( -70.0 * std::numbers::pi / 180.0, 10001, worldPoints );
+    double            fullWallTime = 0.0;
+    for( bool sparse : { false, true } ) {
+        scenario run         = defaultScenario();
+        run.name             = "BenchmarkSparseUpdates";
+        run.numberOfPoints   = 10001;
+        run.shape            = "pulse";
+        run.pulseWidth       = 0.005 * length;
+        run.pulseStart       = 0.3 * length;
+        run.boundary         = fixedEnds;
+        run.deltaTime        = 0.0001;
+        run.endTime          = 1.0;
+        run.snapshotInterval = run.endTime;
+        run.sparseUpdates    = sparse;
+        jobResult result;
+        runJob( run, result );
+        std::filesystem::remove_all( run.outputDirectory + "/" + run.name );
+        const double pointUpdates = result.steps * static_cast<double>( run.numberOfPoints ) / result.wallTime;
+        const char  *name         = sparse ? "pulse sparse updates" : "pulse full sweeps";
+        results.push_back( { name, run.numberOfPoints, pointUpdates, "point updates/s" } );
+        std::cout << std::format( "{} {}: {:.3e} point updates/s, {:.1f}% of points updated", name, run.numberOfPoints, pointUpdates, 100.0 * result.updatedFraction );
+        if( sparse ) {
+            std::cout << std::format( ", {:.1f}x faster", fullWallTime / result.wallTime );
+        }
+        std::cout << std::endl;
+        fullWallTime = result.wallTime;
+    }
+}
+
+void benchmarkSpectrum( std::vector<benchmarkResult> &results ) {
+    // power law initial conditions with every mode the grid holds, the string and velocity each take one sine transform
+    for( int numberOfPoints : { 1001, 100001 } ) {
+        scenario run       = defaultScenario();
+        run.numberOfPoints = numberOfPoints;
+        run.spectrumModes  = numberOfPoints - 2;
+        std::vector<double>           uniform( numberOfPoints, 1.0 );
+        std::vector<double>           stringVector;
+        std::vector<double>           velocity;
+        long long                     repeats = 0;
+        auto                          start   = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed( 0.0 );
+        while( elapsed.count() < minimumBenchmarkTime || repeats < 3 ) {
+            synthesiseSpectrum( run, uniform, uniform, 1.0, stringVector, velocity );
+            repeats += 1;
+            elapsed = std::chrono::steady_clock::now() - start;
+        }
+        const double milliseconds = 1000.0 * elapsed.count() / repeats;
+        results.push_back( { "synthesiseSpectrum", numberOfPoints, milliseconds, "ms" } );
+        std::cout << std::format( "synthesiseSpectrum {} points, {} modes: {:.3f} ms", numberOfPoints, run.spectrumModes, milliseconds ) << std::endl;
+    }
+}
+
+void benchmarkFrameSubmission( std::vector<benchmarkResult> &results ) {
+    // cost of getting a new string on screen in a hidden window, converting, streaming, drawing and waiting for the gpu
+    initialiseGLFW( true );
+    GLFWwindow *window = glfwCreateWindow( 800, 600, "Benchmarks", NULL, NULL );
+    if( window == NULL ) {
+        std::cout << "Skipping frame submission, could not create a hidden window" << std::endl;
+        glfwTerminate();
+        return;
+    }
+    glfwMakeContextCurrent( window );
+    initialiseGLAD();
+
+    unsigned int vertexShader;
+    unsigned int fragmentShader;
+    unsigned int shaderProgram;
+    int          colourLocation;
+    initialiseShaders( vertexShaderSource, fragmentShaderSource, vertexShader, fragmentShader, shaderProgram, colourLocation );
+    unsigned int stringShaderProgram;
+    int          stringColourLocation;
+    initialiseShaders( stringVertexShaderSource, fragmentShaderSource, vertexShader, fragmentShader, stringShaderProgram, stringColourLocation );
+    int firstPointLocation       = glGetUniformLocation( stringShaderProgram, "firstPoint" );
+    int pointsLocation           = glGetUniformLocation( stringShaderProgram, "numberOfPoints" );
+    int verticesPerPointLocation = glGetUniformLocation( stringShaderProgram, "verticesPerPoint" );
+
+    // clang-format off
+    point axes[4] = {
+        {-1.0f, 0.0f},
+        { 1.0f, 0.0f},
+        {0.0f, -1.0f},
+        {0.0f,  1.0f}
+    };
+    // clang-format on
+    const int    numberOfTicksOnAxis = 10;
+    const int    numberOfTicks       = ( 2 * numberOfTicksOnAxis + 1 ) * 4;
+    point        axisTicks[numberOfTicks];
+    unsigned int axesVBO;
+    unsigned int axesVAO;
+    unsigned int axisTicksVBO;
+    unsigned int axisTicksVAO;
+    makeAxisTicks( axisTicks, numberOfTicksOnAxis, 0.01f, window );
+    initialiseAxesVboVao( axesVBO, axesVAO, axes, shaderProgram );
+    initialiseAxisTicksVboVao( axisTicksVBO, axisTicksVAO, axisTicks, shaderProgram, numberOfTicks );
+
+    int framebufferWidth;
+    int framebufferHeight;
+    glfwGetFramebufferSize( window, &framebufferWidth, &framebufferHeight );
+    for( int numberOfPoints = 1000; numberOfPoints <= 1000000; numberOfPoints *= 10 ) {
+        std::vector<double> stringVector = createString( numberOfPoints, 3, 0.5 );
+        unsigned int        VBO;
+        unsigned int        VAO;
+        streamBuffer        stream;
+        initialiseVboVao( VBO, VAO, stream, numberOfPoints, shaderProgram );
+        levelOfDetail lod;
+        makeLevelOfDetail( lod, numberOfPoints, framebufferWidth );
+
+        // every point, then the min/max envelope when the string is wider than the window
+        for( int envelope = 0; envelope < 2; envelope++ ) {
+            if( envelope == 1 && lod.columns == 0 ) {
+                continue;
+            }
+            long long frames = 0;
+            auto      start  = std::chrono::steady_clock::now();
+            std::chrono::duration<double> elapsed( 0.0 );
+            while( elapsed.count() < minimumBenchmarkTime || frames < 10 ) {
+                int drawnVertices    = numberOfPoints;
+                int verticesPerPoint = 1;
+                if( envelope == 0 ) {
+                    convertToFloat( stringVector.data(), beginStreamWrite( stream ), numberOfPoints );
+                }
+                else {
+                    // the string never changes here, so every frame is a full rebuild as if it had
+                    lod.changed      = true;
+                    drawnVertices    = buildEnvelope( lod, stringVector.data(), beginStreamWrite( stream ) );
+                    verticesPerPoint = 2;
+                }
+                endStreamWrite( stream );
+                rendering( shaderProgram, stringShaderProgram, VAO, axesVAO, axisTicksVAO, stream.drawRegion * numberOfPoints, drawnVertices, verticesPerPoint, colourLocation, stringColourLocation, firstPointLocation, pointsLocation, verticesPerPointLocation, numberOfTicks );
+                fenceStream( stream );
+                glFinish();
+                frames += 1;
+                elapsed = std::chrono::steady_clock::now() - start;
+            }
+            double frameTime = elapsed.count() / frames;
+            results.push_back( { envelope == 0 ? "frame submission" : "frame submission envelope", numberOfPoints, 1000.0 * frameTime, "ms/frame" } );
+            std::cout << std::format( "frame submission {}{}: {:.3f} ms/frame", numberOfPoints, envelope == 0 ? "" : " envelope", 1000.0 * frameTime ) << std::endl;
+        }
+        for( int i = 0; i < streamRegions; i++ ) {
+            if( stream.fences[i] != NULL ) {
+                glDeleteSync( stream.fences[i] );
+            }
+        }
+        glDeleteVertexArrays( 1, &VAO );
+        glDeleteBuffers( 1, &VBO );
+    }
+    glfwTerminate();
+}
+
+void saveResults( const std::vector<benchmarkResult> &results, const std::string &fileName ) {
+    // one object per run, the machine details make runs from different computers easy to tell apart
+    std::ofstream json( "../../data/" + fileName );
+    if( !json ) {
+        std::cerr << std::format( "Error: could not open file, {}\n\n", fileName );
+        abort();
+    }
+    auto timestamp = std::chrono::duration_cast<std::chrono::seconds>( std::chrono::system_clock::now().time_since_epoch() ).count();
+    json << "{\n";
+    json << std::format( "  \"timestamp\": {},\n", timestamp );
+    json << std::format( "  \"threads\": {},\n", std::thread::hardware_concurrency() );
+    json << "  \"results\": [\n";
+    for( std::size_t i = 0; i < results.size(); i++ ) {
+        json << std::format( "    {{\"name\": \"{}\", \"size\": {}, \"value\": {:.6e}, \"unit\": \"{}\"}}{}\n", results[i].name, results[i].size, results[i].value, results[i].unit, i + 1 < results.size() ? "," : "" );
+    }
+    json << "  ]\n}\n";
+    std::cout << std::format( "Saved {} results to {}", results.size(), fileName ) << std::endl;
+}
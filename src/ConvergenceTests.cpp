@@ -0,0 +1,365 @@
+// accuracy of the GrandUnifiedModel string integrators against the analytic standing wave
+// a fixed end string started as createString( numberOfPoints, mode, height ) with no velocity is
+// y( x, t ) = height * sin( k x ) * cos( w t ), k = mode * pi / length, w = k * sqrt( tension / mass )
+// every variant is run over a range of grids and time steps, the observed order and the wall time are
+// printed and saved as json so faster kernels can be judged on the accuracy they give per unit of compute
+// the reduced precision kernels are then checked against the double kernels, the program fails if a compensated one drifts
+// and the spectral initial conditions are checked against sums of the standing wave shapes they are built from
+
+// includes
+// --------
+
+#define GRAND_UNIFIED_MODEL_NO_MAIN
+#include "GrandUnifiedModel.cpp"
+
+// structs
+// -------
+
+typedef void ( *stringIntegrator )( std::vector<double> &stringVector, std::vector<double> &velocity, const std::vector<double> &mass, const int numberOfPoints, const std::vector<double> &tension, const double deltaLength, const double deltaTime );
+
+struct integratorVariant // an integrator and how it is started
+{
+    const char      *name;
+    stringIntegrator update;
+    bool             staggeredStart; // the velocity is taken to be half a step behind the string, so it starts at v( -dt / 2 )
+    double           largestCourant; // where the time sweep starts, implicit schemes can go well past 1
+};
+
+struct convergenceResult // one run of one variant
+{
+    std::string name;
+    std::string sweep; // "grid" refines space and time together, "time" refines only the time step
+    int         numberOfPoints;
+    double      deltaTime; // (secconds)
+    long long   steps;
+    double      error;    // largest |y - y exact| at the end of the run
+    double      order;    // observed order from the previous, coarser run, 0 for the first
+    double      wallTime; // (secconds)
+};
+
+struct precisionResult // one reduced precision run against the double run of the same case
+{
+    std::string name;
+    std::string test;
+    double      error;            // largest |y - y double| over the largest |y double|
+    double      energyDifference; // |E - E double| over E double at the end of the run
+    double      wallTime;         // (secconds)
+};
+
+// test settings
+// -------------
+
+const double testLength  = 1.0;  // length of the string (meters)
+const double testHeight  = 1.0;  // amplitude of the standing wave (meters)
+const int    testMode    = 3;    // number of half wavelengths along the string
+const double testCourant = 0.5;  // c * dt / dx used for the grid sweep
+const double testPeriods = 1.25; // length of each run, ending a quarter period off so phase errors show up fully
+
+const double precisionTolerance = 1e-3; // largest relative error allowed for the compensated float kernels
+const double precisionEndTime   = 10.0; // length of the field line runs (secconds)
+
+const double spectrumTolerance = 1e-10; // largest error allowed in the synthesised string relative to its height
+
+// function prototypes
+// -------------------
+
+void fixedString( std::vector<double> &stringVector, std::vector<double> &velocity, const std::vector<double> &mass, const int numberOfPoints, const std::vector<double> &tension, const double deltaLength, const double deltaTime );
+
+void crankNicolsonString( std::vector<double> &stringVector, std::vector<double> &velocity, const std::vector<double> &mass, const int numberOfPoints, const std::vector<double> &tension, const double deltaLength, const double deltaTime );
+
+convergenceResult runStandingWave( const integratorVariant &variant, const int numberOfPoints, const double courant );
+
+void gridSweep( const integratorVariant &variant, std::vector<convergenceResult> &results );
+
+void timeSweep( const integratorVariant &variant, std::vector<convergenceResult> &results );
+
+void saveConvergence( const std::vector<convergenceResult> &results, const std::string &fileName );
+
+template <precisionMode mode>
+precisionResult runPrecision( const std::string &test, const stringBoundary boundary, const std::vector<double> &initialString, const std::vector<double> &tension, const std::vector<double> &mass, const double deltaLength, const double deltaTime, const long long steps, const double dampingCoefficient, const std::vector<double> &reference, const double referenceEnergy );
+
+bool precisionCheck( const std::string &test, const stringBoundary boundary, const std::vector<double> &initialString, const std::vector<double> &tension, const std::vector<double> &mass, const double deltaLength, const double deltaTime, const long long steps, const double dampingCoefficient, std::vector<precisionResult> &results );
+
+void savePrecision( const std::vector<precisionResult> &results, const std::string &fileName );
+
+bool spectrumCheck( const int numberOfPoints );
+
+// main
+// ----
+
+int main() {
+    // clang-format off
+    const integratorVariant variants[] = {
+        { "updateFixedString",                 fixedString,         false, 0.8  },
+        { "updateFixedString staggered start", fixedString,         true,  0.8  },
+        { "updateCrankNicolsonString",         crankNicolsonString, false, 51.2 }
+    };
+    // clang-format on
+    std::vector<convergenceResult> results;
+    for( const integratorVariant &variant : variants ) {
+        gridSweep( variant, results );
+        timeSweep( variant, results );
+    }
+    saveConvergence( results, "ConvergenceResults.json" );
+
+    // precision, a standing wave on a uniform string and the default field line
+    std::vector<precisionResult> precisionResults;
+    bool                         passed = true;
+    {
+        const int    numberOfPoints = 1025;
+        const double deltaLength    = testLength / ( numberOfPoints - 1 );
+        const double deltaTime      = testCourant * deltaLength;
+        const long long steps       = static_cast<long long>( 20.0 * testLength / deltaTime );
+        passed &= precisionCheck( "standing wave", fixedEnds, createString( numberOfPoints, testMode, testHeight ), std::vector<double>( numberOfPoints, 1.0 ), std::vector<double>( numberOfPoints, 1.0 ), deltaLength, deltaTime, steps, 0.0, precisionResults );
+    }
+    {
+        const scenario      run      = defaultScenario();
+        const double        latitude = -run.latitudeDegrees * std::numbers::pi / 180.0;
+        std::vector<vec3>   worldPoints;
+        const double        length = lengthOfMagneticFieldLine( latitude, run.numberOfPoints, worldPoints );
+        std::vector<double> tension( run.numberOfPoints, 0.0 );
+        std::vector<double> mass( run.numberOfPoints, 0.0 );
+        updateTensionMass( run.numberOfPoints, worldPoints, latitude, tension, mass );
+        const long long steps = static_cast<long long>( precisionEndTime / run.deltaTime );
+        passed &= precisionCheck( "field line", run.boundary, createScenarioString( run, length ), tension, mass, length / ( run.numberOfPoints - 1 ), run.deltaTime, steps, run.dampingCoefficient, precisionResults );
+    }
+    savePrecision( precisionResults, "PrecisionResults.json" );
+
+    // spectral synthesis, 1025 points is a power of two transform and 1001 goes through bluestein
+    passed &= spectrumCheck( 1025 );
+    passed &= spectrumCheck( 1001 );
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// functions
+// ---------
+
+void fixedString( std::vector<double> &stringVector, std::vector<double> &velocity, const std::vector<double> &mass, const int numberOfPoints, const std::vector<double> &tension, const double deltaLength, const double deltaTime ) {
+    stringDiagnostics diagnostics;
+    updateFixedString( stringVector, velocity, mass, numberOfPoints, tension, deltaLength, deltaTime, diagnostics );
+}
+
+void crankNicolsonString( std::vector<double> &stringVector, std::vector<double> &velocity, const std::vector<double> &mass, const int numberOfPoints, const std::vector<double> &tension, const double deltaLength, const double deltaTime ) {
+    // the factorisation is kept between calls and only redone when a run changes the grid or time step
+    static crankNicolsonOperator implicitOperator;
+    static double                factorisedLength = 0.0;
+    stringDiagnostics            diagnostics;
+    if( static_cast<int>( implicitOperator.coefficient.size() ) != numberOfPoints || implicitOperator.deltaTime != deltaTime || factorisedLength != deltaLength ) {
+        factoriseCrankNicolson( implicitOperator, fixedEnds, mass, numberOfPoints, tension, deltaLength, deltaTime, 0.0 );
+        factorisedLength = deltaLength;
+    }
+    updateCrankNicolsonString( implicitOperator, stringVector, velocity, mass, numberOfPoints, tension, deltaLength, diagnostics );
+}
+
+convergenceResult runStandingWave( const integratorVariant &variant, const int numberOfPoints, const double courant ) {
+    // uniform string with a wave speed of 1, the time step is shrunk slightly so the run ends exactly on the end time
+    const double    deltaLength = testLength / ( numberOfPoints - 1 );
+    const double    k           = testMode * std::numbers::pi / testLength;
+    const double    w           = k; // wave speed is 1
+    const double    endTime     = testPeriods * 2.0 * std::numbers::pi / w;
+    const long long steps       = static_cast<long long>( std::ceil( endTime / ( courant * deltaLength ) ) );
+    const double    deltaTime   = endTime / steps;
+
+    std::vector<double> stringVector = createString( numberOfPoints, testMode, testHeight );
+    std::vector<double> exact        = stringVector;
+    for( int i = 0; i < numberOfPoints; i++ ) {
+        exact[i] *= std::cos( w * endTime );
+    }
+    std::vector<double> velocity( numberOfPoints, 0.0 );
+    std::vector<double> mass( numberOfPoints, 1.0 );
+    std::vector<double> tension( numberOfPoints, 1.0 );
+    if( variant.staggeredStart ) {
+        // dy/dt = -height * w * sin( k x ) * sin( w t ) at t = -dt / 2
+        for( int i = 0; i < numberOfPoints; i++ ) {
+            velocity[i] = stringVector[i] * w * std::sin( w * deltaTime / 2.0 );
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for( long long step = 0; step < steps; step++ ) {
+        variant.update( stringVector, velocity, mass, numberOfPoints, tension, deltaLength, deltaTime );
+    }
+    std::chrono::duration<double> wallTime = std::chrono::steady_clock::now() - start;
+
+    double error = 0.0;
+    for( int i = 0; i < numberOfPoints; i++ ) {
+        error = std::max( error, std::abs( stringVector[i] - exact[i] ) );
+    }
+    return { variant.name, "", numberOfPoints, deltaTime, steps, error, 0.0, wallTime.count() };
+}
+
+void gridSweep( const integratorVariant &variant, std::vector<convergenceResult> &results ) {
+    // halves dx and dt together, a second order scheme should cut the error by 4 each time
+    std::cout << std::format( "{}, grid sweep at courant number {}\n", variant.name, testCourant );
+    std::cout << "points\tdt\terror\torder\twall time (s)\n";
+    double previousError = 0.0;
+    for( int numberOfPoints = 33; numberOfPoints <= 4097; numberOfPoints = 2 * numberOfPoints - 1 ) {
+        convergenceResult result = runStandingWave( variant, numberOfPoints, testCourant );
+        result.sweep             = "grid";
+        if( previousError > 0.0 ) {
+            result.order = std::log2( previousError / result.error );
+        }
+        previousError = result.error;
+        std::cout << std::format( "{}\t{:.3e}\t{:.3e}\t{:.2f}\t{:.4f}\n", result.numberOfPoints, result.deltaTime, result.error, result.order, result.wallTime );
+        results.push_back( result );
+    }
+    std::cout << std::endl;
+}
+
+void timeSweep( const integratorVariant &variant, std::vector<convergenceResult> &results ) {
+    // fixed fine grid with shrinking time steps, shows when the time error stops mattering next to the space error
+    const int numberOfPoints = 1025;
+    std::cout << std::format( "{}, time sweep with {} points\n", variant.name, numberOfPoints );
+    std::cout << "courant\tdt\terror\torder\twall time (s)\n";
+    double previousError = 0.0;
+    for( double courant = variant.largestCourant; courant > 0.04; courant /= 2.0 ) {
+        convergenceResult result = runStandingWave( variant, numberOfPoints, courant );
+        result.sweep             = "time";
+        if( previousError > 0.0 ) {
+            result.order = std::log2( previousError / result.error );
+        }
+        previousError = result.error;
+        std::cout << std::format( "{:.3f}\t{:.3e}\t{:.3e}\t{:.2f}\t{:.4f}\n", courant, result.deltaTime, result.error, result.order, result.wallTime );
+        results.push_back( result );
+    }
+    std::cout << std::endl;
+}
+
+void saveConvergence( const std::vector<convergenceResult> &results, const std::string &fileName ) {
+    std::ofstream json( "../../data/" + fileName );
+    if( !json ) {
+        std::cerr << std::format( "Error: could not open file, {}\n\n", fileName );
+        abort();
+    }
+    json << "[\n";
+    for( std::size_t i = 0; i < results.size(); i++ ) {
+        const convergenceResult &result = results[i];
+        json << std::format( "  {{\"name\": \"{}\", \"sweep\": \"{}\", \"points\": {}, \"deltaTime\": {:.6e}, \"steps\": {}, \"error\": {:.6e}, \"order\": {:.3f}, \"wallTime\": {:.6e}}}{}\n", result.name, result.sweep, result.numberOfPoints, result.deltaTime, result.steps, result.error, result.order, result.wallTime, i + 1 < results.size() ? "," : "" );
+    }
+    json << "]\n";
+    std::cout << std::format( "Saved {} results to {}", results.size(), fileName ) << std::endl;
+}
+
+template <precisionMode mode>
+precisionResult runPrecision( const std::string &test, const stringBoundary boundary, const std::vector<double> &initialString, const std::vector<double> &tension, const std::vector<double> &mass, const double deltaLength, const double deltaTime, const long long steps, const double dampingCoefficient, const std::vector<double> &reference, const double referenceEnergy ) {
+    typedef storageType<mode> real;
+    const int         numberOfPoints = static_cast<int>( initialString.size() );
+    std::vector<real> stringVector( initialString.begin(), initialString.end() );
+    std::vector<real> velocity( numberOfPoints, real( 0 ) );
+    std::vector<real> compensation( numberOfPoints, real( 0 ) );
+    std::vector<real> coefficient( numberOfPoints );
+    std::vector<real> weight( numberOfPoints );
+    for( int i = 0; i < numberOfPoints; i++ ) {
+        coefficient[i] = static_cast<real>( tension[i] / ( mass[i] * deltaLength * deltaLength ) );
+        weight[i]      = static_cast<real>( mass[i] * deltaLength / tension[i] );
+    }
+    stringDiagnostics diagnostics;
+
+    auto start = std::chrono::steady_clock::now();
+    for( long long step = 0; step < steps; step++ ) {
+        updateMixedString<mode>( boundary, stringVector, velocity, compensation, coefficient, weight, numberOfPoints, deltaTime, dampingCoefficient, diagnostics );
+    }
+    std::chrono::duration<double> wallTime = std::chrono::steady_clock::now() - start;
+
+    double error   = 0.0;
+    double largest = 0.0;
+    for( int i = 0; i < numberOfPoints; i++ ) {
+        error   = std::max( error, std::abs( stringVector[i] - reference[i] ) );
+        largest = std::max( largest, std::abs( reference[i] ) );
+    }
+    const double energy = diagnostics.kineticEnergy + diagnostics.potentialEnergy;
+    return { "", test, error / largest, std::abs( energy - referenceEnergy ) / referenceEnergy, wallTime.count() };
+}
+
+bool precisionCheck( const std::string &test, const stringBoundary boundary, const std::vector<double> &initialString, const std::vector<double> &tension, const std::vector<double> &mass, const double deltaLength, const double deltaTime, const long long steps, const double dampingCoefficient, std::vector<precisionResult> &results ) {
+    // the double reference kernel gives the baseline, plain float is only reported as it isnt expected to hold up
+    const int           numberOfPoints = static_cast<int>( initialString.size() );
+    std::vector<double> reference      = initialString;
+    std::vector<double> velocity( numberOfPoints, 0.0 );
+    stringDiagnostics   diagnostics;
+    auto                start = std::chrono::steady_clock::now();
+    for( long long step = 0; step < steps; step++ ) {
+        updateString( boundary, reference, velocity, mass, numberOfPoints, tension, deltaLength, deltaTime, dampingCoefficient, diagnostics );
+    }
+    std::chrono::duration<double> referenceTime   = std::chrono::steady_clock::now() - start;
+    const double                  referenceEnergy = diagnostics.kineticEnergy + diagnostics.potentialEnergy;
+
+    // clang-format off
+    precisionResult runs[] = {
+        runPrecision<doublePrecision>(         test, boundary, initialString, tension, mass, deltaLength, deltaTime, steps, dampingCoefficient, reference, referenceEnergy ),
+        runPrecision<floatPrecision>(          test, boundary, initialString, tension, mass, deltaLength, deltaTime, steps, dampingCoefficient, reference, referenceEnergy ),
+        runPrecision<floatDoubleAccumulation>( test, boundary, initialString, tension, mass, deltaLength, deltaTime, steps, dampingCoefficient, reference, referenceEnergy ),
+        runPrecision<floatKahanAccumulation>(  test, boundary, initialString, tension, mass, deltaLength, deltaTime, steps, dampingCoefficient, reference, referenceEnergy )
+    };
+    const char *names[]   = { "double in place", "float", "float, double arithmetic", "float, kahan summation" };
+    const bool  checked[] = { true,              false,   true,                       true                     };
+    // clang-format on
+
+    std::cout << std::format( "{}, {} points for {} steps, double reference took {:.4f}s\n", test, numberOfPoints, steps, referenceTime.count() );
+    std::cout << "kernel\t\t\t\terror\t\tenergy\t\twall time (s)\n";
+    bool passed = true;
+    for( int i = 0; i < 4; i++ ) {
+        runs[i].name           = names[i];
+        const bool withinLimit = runs[i].error < precisionTolerance;
+        std::cout << std::format( "{:<32}{:.3e}\t{:.3e}\t{:.4f}{}\n", runs[i].name, runs[i].error, runs[i].energyDifference, runs[i].wallTime, !withinLimit ? ( checked[i] ? "\tFAILED" : "\tover tolerance" ) : "" );
+        if( checked[i] && !withinLimit ) {
+            passed = false;
+        }
+        results.push_back( runs[i] );
+    }
+    std::cout << std::endl;
+    return passed;
+}
+
+void savePrecision( const std::vector<precisionResult> &results, const std::string &fileName ) {
+    std::ofstream json( "../../data/" + fileName );
+    if( !json ) {
+        std::cerr << std::format( "Error: could not open file, {}\n\n", fileName );
+        abort();
+    }
+    json << "[\n";
+    for( std::size_t i = 0; i < results.size(); i++ ) {
+        const precisionResult &result = results[i];
+        json << std::format( "  {{\"name\": \"{}\", \"test\": \"{}\", \"error\": {:.6e}, \"energyDifference\": {:.6e}, \"wallTime\": {:.6e}}}{}\n", result.name, result.test, result.error, result.energyDifference, result.wallTime, i + 1 < results.size() ? "," : "" );
+    }
+    json << "]\n";
+    std::cout << std::format( "Saved {} results to {}", results.size(), fileName ) << std::endl;
+}
+
+bool spectrumCheck( const int numberOfPoints ) {
+    // explicit modes with no phase have no velocity and must equal the sum of the standing shapes, a power law
+    // spectrum must come out the same from the same seed and differently from another
+    scenario run       = defaultScenario();
+    run.numberOfPoints = numberOfPoints;
+    run.height         = testHeight;
+    run.modeAmplitudes = { 1.0, -0.5, 0.0, 0.25, 0.125, 0.0625, 0.03125, 0.015625 };
+    std::vector<double> uniform( numberOfPoints, 1.0 );
+    std::vector<double> stringVector;
+    std::vector<double> velocity;
+    synthesiseSpectrum( run, uniform, uniform, testLength / ( numberOfPoints - 1 ), stringVector, velocity );
+    std::vector<double> expected( numberOfPoints, 0.0 );
+    for( int mode = 1; mode <= static_cast<int>( run.modeAmplitudes.size() ); mode++ ) {
+        const std::vector<double> shape = createString( numberOfPoints, mode, testHeight * run.modeAmplitudes[mode - 1] );
+        for( int i = 0; i < numberOfPoints; i++ ) {
+            expected[i] += shape[i];
+        }
+    }
+    double error = 0.0;
+    for( int i = 0; i < numberOfPoints; i++ ) {
+        error = std::max( { error, std::abs( stringVector[i] - expected[i] ), std::abs( velocity[i] ) } );
+    }
+
+    run.modeAmplitudes.clear();
+    std::vector<double> first;
+    std::vector<double> repeat;
+    std::vector<double> reseeded;
+    synthesiseSpectrum( run, uniform, uniform, testLength / ( numberOfPoints - 1 ), first, velocity );
+    synthesiseSpectrum( run, uniform, uniform, testLength / ( numberOfPoints - 1 ), repeat, velocity );
+    run.spectrumSeed += 1;
+    synthesiseSpectrum( run, uniform, uniform, testLength / ( numberOfPoints - 1 ), reseeded, velocity );
+    const bool deterministic = first == repeat && first != reseeded;
+
+    const bool passed = error / testHeight < spectrumTolerance && deterministic;
+    std::cout << std::format( "spectrum, {} points: error {:.3e}, {}{}\n", numberOfPoints, error / testHeight, deterministic ? "deterministic" : "not deterministic", passed ? "" : "\tFAILED" );
+    return passed;
+}
@@ -0,0 +1,372 @@
+// distributed memory version of the GrandUnifiedModel string solver
+// every MPI rank owns a contiguous segment of the field line with one halo point either side, the halos are swapped with
+// non blocking sends that run while the rank updates the points that dont need them, snapshots go into one file through MPI-IO
+// the split is for speed not memory, every rank traces the whole field line and builds the whole string at start up, so each rank
+// briefly needs as much memory as the serial run, only its own segment is kept once the run starts
+// built like Benchmarks.cpp with mpicxx in place of the compiler, then
+//   mpirun -np 4 DistributedString file.ini [scenario]     runs a scenario split over the ranks
+//   mpirun -np 4 DistributedString --weak pointsPerRank    times a string that grows with the number of ranks
+
+// includes
+// --------
+
+#define GRAND_UNIFIED_MODEL_NO_MAIN
+#include "GrandUnifiedModel.cpp"
+
+#include <mpi.h>
+
+// structs
+// -------
+
+struct stringSegment // the part of the string a rank owns, local point 1 is global point globalFirst
+{
+    int                 rank;
+    int                 ranks;
+    int                 globalFirst;
+    int                 count;        // points owned by this rank
+    int                 totalPoints;  // points in the whole string
+    std::vector<double> stringVector; // count + 2, the first and last values are halos from the neighbouring ranks
+    std::vector<double> nextString;   // the string being written this step, swapped with stringVector after it
+    std::vector<double> velocity;     // count + 2 so the indices match the string
+    std::vector<double> coefficient;  // tension / ( mass * deltaLength^2 )
+    std::vector<double> weight;       // mass * deltaLength / tension, the kinetic weight of each point
+    double              haloTime;     // time spent waiting on halos (secconds)
+    double              stableTime;   // largest safe explicit time step, every rank traces the whole line so they all agree (secconds)
+};
+
+// settings
+// --------
+
+const int distributedCheckInterval = 100; // steps between the energy reductions used to stop an unstable run
+
+const int weakScalingSteps = 2000; // steps timed for each weak scaling run
+
+// function prototypes
+// -------------------
+
+void initialiseSegment( stringSegment &segment, const scenario &run, double &deltaLength, double &length );
+
+void updateSegmentPoint( stringSegment &segment, const int i, const stringBoundary boundary, const double deltaTime, const double dampingCoefficient );
+
+void stepSegment( stringSegment &segment, const stringBoundary boundary, const double deltaTime, const double dampingCoefficient );
+
+stringDiagnostics reduceDiagnostics( const stringSegment &segment, const double deltaLength );
+
+void openSnapshots( MPI_File &file, const stringSegment &segment, const std::string &fileName, const double deltaLength );
+
+void writeSnapshot( MPI_File &file, const stringSegment &segment, const long long snapshot, const double time );
+
+int runDistributed( const scenario &run, const int rank, const int ranks );
+
+int runWeakScaling( const int pointsPerRank, const int rank, const int ranks );
+
+// main
+// ----
+
+int main( int argc, char *argv[] ) {
+    MPI_Init( &argc, &argv );
+    int rank;
+    int ranks;
+    MPI_Comm_rank( MPI_COMM_WORLD, &rank );
+    MPI_Comm_size( MPI_COMM_WORLD, &ranks );
+
+    int status = EXIT_SUCCESS;
+    if( argc >= 3 && std::string( argv[1] ) == "--weak" ) {
+        status = runWeakScaling( std::stoi( argv[2] ), rank, ranks );
+    }
+    else {
+        // every rank reads the scenario file, it is small and saves broadcasting it
+        scenario run = defaultScenario();
+        if( argc >= 2 ) {
+            std::vector<scenario> scenarios = loadScenarios( argv[1] );
+            run                             = scenarios.front();
+            if( argc >= 3 ) {
+                auto found = std::find_if( scenarios.begin(), scenarios.end(), [&]( const scenario &candidate ) { return candidate.name == argv[2]; } );
+                if( found == scenarios.end() ) {
+                    if( rank == 0 ) {
+                        std::cerr << std::format( "Error: no scenario called {} in {}\n\n", argv[2], argv[1] );
+                    }
+                    MPI_Abort( MPI_COMM_WORLD, EXIT_FAILURE );
+                }
+                run = *found;
+            }
+        }
+        status = runDistributed( run, rank, ranks );
+    }
+    MPI_Finalize();
+    return status;
+}
+
+// functions
+// ---------
+
+void initialiseSegment( stringSegment &segment, const scenario &run, double &deltaLength, double &length ) {
+    // every rank traces the whole field line and keeps its own part, the whole line vectors are freed when this returns
+    MPI_Comm_rank( MPI_COMM_WORLD, &segment.rank );
+    MPI_Comm_size( MPI_COMM_WORLD, &segment.ranks );
+    const int numberOfPoints = run.numberOfPoints;
+    const int share          = numberOfPoints / segment.ranks;
+    const int remainder      = numberOfPoints % segment.ranks;
+    segment.totalPoints      = numberOfPoints;
+    segment.count            = share + ( segment.rank < remainder ? 1 : 0 );
+    segment.globalFirst      = segment.rank * share + std::min( segment.rank, remainder );
+    segment.haloTime         = 0.0;
+
+    const double        latitude = -run.latitudeDegrees * std::numbers::pi / 180.0;
+    std::vector<vec3>   worldPoints;
+    length                           = lengthOfMagneticFieldLine( latitude, numberOfPoints, worldPoints );
+    deltaLength                      = length / ( numberOfPoints - 1 );
+    std::vector<double> stringVector = createScenarioString( run, length );
+    std::vector<double> tension( numberOfPoints, 0.0 );
+    std::vector<double> mass( numberOfPoints, 0.0 );
+    std::vector<double> velocity( numberOfPoints, 0.0 );
+    updateTensionMass( numberOfPoints, worldPoints, latitude, tension, mass );
+    segment.stableTime = stableDeltaTime( tension, mass, deltaLength, numberOfPoints, run.boundary, run.dampingCoefficient );
+    if( run.shape == "spectrum" ) {
+        synthesiseSpectrum( run, tension, mass, deltaLength, stringVector, velocity );
+    }
+
+    segment.stringVector.assign( segment.count + 2, 0.0 );
+    segment.nextString.assign( segment.count + 2, 0.0 );
+    segment.velocity.assign( segment.count + 2, 0.0 );
+    segment.coefficient.assign( segment.count + 2, 0.0 );
+    segment.weight.assign( segment.count + 2, 0.0 );
+    for( int i = 1; i <= segment.count; i++ ) {
+        const int global        = segment.globalFirst + i - 1;
+        segment.stringVector[i] = stringVector[global];
+        segment.velocity[i]     = velocity[global];
+        segment.coefficient[i]  = tension[global] / ( mass[global] * deltaLength * deltaLength );
+        segment.weight[i]       = mass[global] * deltaLength / tension[global];
+    }
+}
+
+void updateSegmentPoint( stringSegment &segment, const int i, const stringBoundary boundary, const double deltaTime, const double dampingCoefficient ) {
+    // the points either side of the halos, the ends of the whole string follow the run's boundary
+    const double *y     = segment.stringVector.data();
+    double       &v     = segment.velocity[i];
+    const bool    first = segment.rank == 0 && i == 1;
+    const bool    last  = segment.rank == segment.ranks - 1 && i == segment.count;
+    if( first || last ) {
+        if( boundary == fixedEnds ) {
+            segment.nextString[i] = y[i];
+            return;
+        }
+        const double damping   = boundary == dampedEnds ? dampingCoefficient : 0.0;
+        const double neighbour = first ? y[i + 1] : y[i - 1];
+        v += ( segment.coefficient[i] * ( neighbour - y[i] ) - damping * v ) * deltaTime;
+    }
+    else {
+        v += segment.coefficient[i] * ( y[i - 1] - 2.0 * y[i] + y[i + 1] ) * deltaTime;
+    }
+    segment.nextString[i] = y[i] + v * deltaTime;
+}
+
+void stepSegment( stringSegment &segment, const stringBoundary boundary, const double deltaTime, const double dampingCoefficient ) {
+    // halos are posted first, the points that only need this rank's values are updated while they travel
+    MPI_Request requests[4];
+    int         requestCount = 0;
+    double     *y            = segment.stringVector.data();
+    if( segment.rank > 0 ) {
+        MPI_Irecv( &y[0], 1, MPI_DOUBLE, segment.rank - 1, 0, MPI_COMM_WORLD, &requests[requestCount++] );
+        MPI_Isend( &y[1], 1, MPI_DOUBLE, segment.rank - 1, 1, MPI_COMM_WORLD, &requests[requestCount++] );
+    }
+    if( segment.rank < segment.ranks - 1 ) {
+        MPI_Irecv( &y[segment.count + 1], 1, MPI_DOUBLE, segment.rank + 1, 1, MPI_COMM_WORLD, &requests[requestCount++] );
+        MPI_Isend( &y[segment.count], 1, MPI_DOUBLE, segment.rank + 1, 0, MPI_COMM_WORLD, &requests[requestCount++] );
+    }
+    // the same update as the serial kernels
+    const double *__restrict k    = segment.coefficient.data();
+    double *__restrict       v    = segment.velocity.data();
+    double *__restrict       next = segment.nextString.data();
+    for( int i = 2; i < segment.count; i++ ) {
+        v[i] += k[i] * ( y[i - 1] - 2.0 * y[i] + y[i + 1] ) * deltaTime;
+        next[i] = y[i] + v[i] * deltaTime;
+    }
+    const double waitStart = MPI_Wtime();
+    MPI_Waitall( requestCount, requests, MPI_STATUSES_IGNORE );
+    segment.haloTime += MPI_Wtime() - waitStart;
+    updateSegmentPoint( segment, 1, boundary, deltaTime, dampingCoefficient );
+    if( segment.count > 1 ) {
+        updateSegmentPoint( segment, segment.count, boundary, deltaTime, dampingCoefficient );
+    }
+    std::swap( segment.stringVector, segment.nextString );
+}
+
+stringDiagnostics reduceDiagnostics( const stringSegment &segment, const double deltaLength ) {
+    // energies summed over every rank, the segment from the last owned point to the right neighbour's first point belongs to this rank,
+    // the halos in stringVector are from the step before the swap so the neighbour's first point is fetched again here
+    double        local[3] = { 0.0, 0.0, 0.0 }; // kinetic, potential, largest |y|
+    const double *y        = segment.stringVector.data();
+    const int     left     = segment.rank > 0 ? segment.rank - 1 : MPI_PROC_NULL;
+    const int     right    = segment.rank < segment.ranks - 1 ? segment.rank + 1 : MPI_PROC_NULL;
+    double        rightY   = 0.0;
+    MPI_Sendrecv( &y[1], 1, MPI_DOUBLE, left, 2, &rightY, 1, MPI_DOUBLE, right, 2, MPI_COMM_WORLD, MPI_STATUS_IGNORE );
+    for( int i = 1; i <= segment.count; i++ ) {
+        local[0] += segment.weight[i] * segment.velocity[i] * segment.velocity[i];
+        local[2] = std::max( local[2], std::abs( y[i] ) );
+    }
+    for( int i = 1; i < segment.count; i++ ) {
+        const double slope = y[i + 1] - y[i];
+        local[1] += slope * slope;
+    }
+    if( right != MPI_PROC_NULL ) {
+        const double slope = rightY - y[segment.count];
+        local[1] += slope * slope;
+    }
+    double total[2];
+    double largest;
+    MPI_Allreduce( local, total, 2, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD );
+    MPI_Allreduce( &local[2], &largest, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD );
+    stringDiagnostics diagnostics;
+    diagnostics.kineticEnergy   = 0.5 * total[0];
+    diagnostics.potentialEnergy = 0.5 * total[1] / deltaLength;
+    diagnostics.dampingLoss     = 0.0;
+    diagnostics.maxDisplacement = largest;
+    return diagnostics;
+}
+
+void openSnapshots( MPI_File &file, const stringSegment &segment, const std::string &fileName, const double deltaLength ) {
+    // header of "GUMS", the number of points as an int32 and deltaLength, then one record of time and string per snapshot
+    MPI_File_open( MPI_COMM_WORLD, fileName.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file );
+    MPI_File_set_size( file, 0 );
+    if( segment.rank == 0 ) {
+        char header[16];
+        std::memcpy( header, "GUMS", 4 );
+        const int32_t points = segment.totalPoints;
+        std::memcpy( header + 4, &points, 4 );
+        std::memcpy( header + 8, &deltaLength, 8 );
+        MPI_File_write_at( file, 0, header, 16, MPI_BYTE, MPI_STATUS_IGNORE );
+    }
+}
+
+void writeSnapshot( MPI_File &file, const stringSegment &segment, const long long snapshot, const double time ) {
+    // every rank writes its own points straight into place, the time is written by the first rank
+    const MPI_Offset record = 8 + static_cast<MPI_Offset>( segment.totalPoints ) * 8;
+    const MPI_Offset start  = 16 + snapshot * record;
+    if( segment.rank == 0 ) {
+        MPI_File_write_at( file, start, &time, 1, MPI_DOUBLE, MPI_STATUS_IGNORE );
+    }
+    MPI_File_write_at_all( file, start + 8 + static_cast<MPI_Offset>( segment.globalFirst ) * 8, segment.stringVector.data() + 1, segment.count, MPI_DOUBLE, MPI_STATUS_IGNORE );
+}
+
+int runDistributed( const scenario &run, const int rank, const int ranks ) {
+    // explicit steps only, the implicit solve is a sequential sweep along the whole string
+    if( run.scheme != explicitScheme ) {
+        if( rank == 0 ) {
+            std::cerr << std::format( "Error: {} uses crank nicolson, which isnt split over ranks\n\n", run.name );
+        }
+        return EXIT_FAILURE;
+    }
+    if( run.numberOfPoints < 2 * ranks ) {
+        if( rank == 0 ) {
+            std::cerr << std::format( "Error: {} points is too few for {} ranks\n\n", run.numberOfPoints, ranks );
+        }
+        return EXIT_FAILURE;
+    }
+    stringSegment segment;
+    double        deltaLength;
+    double        length;
+    try {
+        initialiseSegment( segment, run, deltaLength, length );
+    }
+    catch( const std::invalid_argument &error ) {
+        // every rank builds the same string, so they all stop here together
+        if( rank == 0 ) {
+            std::cerr << std::format( "Error: {}, {}\n\n", run.name, error.what() );
+        }
+        return EXIT_FAILURE;
+    }
+    const double deltaTime = run.autoDeltaTime ? segment.stableTime : run.deltaTime;
+
+    const std::string directory = run.outputDirectory + "/" + run.name;
+    if( rank == 0 ) {
+        std::filesystem::create_directories( directory );
+    }
+    MPI_Barrier( MPI_COMM_WORLD );
+    MPI_File snapshots;
+    openSnapshots( snapshots, segment, directory + "/DistributedSnapshots.bin", deltaLength );
+
+    double    time          = 0.0;
+    long long steps         = 0;
+    long long snapshot      = 0;
+    double    initialEnergy = 0.0;
+    bool      unstable      = false;
+    double    start         = MPI_Wtime();
+    while( time + 1e-4 < run.endTime ) {
+        if( time + 1e-4 >= snapshot * run.snapshotInterval ) {
+            writeSnapshot( snapshots, segment, snapshot, time );
+            snapshot += 1;
+        }
+        stepSegment( segment, run.boundary, deltaTime, run.dampingCoefficient );
+        time += deltaTime;
+        steps += 1;
+        if( steps == 1 || steps % distributedCheckInterval == 0 ) {
+            // damping loss isnt tracked here, so the check is only on energy growing
+            stringDiagnostics diagnostics = reduceDiagnostics( segment, deltaLength );
+            if( isUnstable( diagnostics, steps, initialEnergy ) ) {
+                unstable = true;
+                break;
+            }
+        }
+    }
+    writeSnapshot( snapshots, segment, snapshot, time );
+    MPI_File_close( &snapshots );
+    const double wallTime = MPI_Wtime() - start;
+
+    double haloTime;
+    MPI_Reduce( &segment.haloTime, &haloTime, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD );
+    if( rank == 0 ) {
+        if( unstable ) {
+            std::cerr << std::format( "Error: {} unstable at {:.4f}s, check the time step against the wave speed\n\n", run.name, time );
+        }
+        std::cout << std::format( "{}: {} points on {} ranks, {} steps to {:.3f}s in {:.3f}s, {:.3e} point updates/s, longest halo wait {:.3f}s, {} snapshots saved to {}/DistributedSnapshots.bin", run.name, run.numberOfPoints, ranks, steps, time, wallTime, steps * static_cast<double>( run.numberOfPoints ) / wallTime, haloTime, snapshot + 1, directory ) << std::endl;
+    }
+    return unstable ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int runWeakScaling( const int pointsPerRank, const int rank, const int ranks ) {
+    // the string grows with the ranks so each rank's work stays the same, flat step times mean the halo exchange is hidden
+    scenario run       = defaultScenario();
+    run.name           = "WeakScaling";
+    run.numberOfPoints = pointsPerRank * ranks + 1;
+    stringSegment segment;
+    double        deltaLength;
+    double        length;
+    initialiseSegment( segment, run, deltaLength, length );
+
+    // half the explicit limit of the fastest point on the whole string
+    double fastest = 0.0;
+    for( int i = 1; i <= segment.count; i++ ) {
+        fastest = std::max( fastest, std::sqrt( segment.coefficient[i] ) * deltaLength );
+    }
+    MPI_Allreduce( MPI_IN_PLACE, &fastest, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD );
+    run.deltaTime = 0.5 * deltaLength / fastest;
+
+    MPI_Barrier( MPI_COMM_WORLD );
+    const double start = MPI_Wtime();
+    for( int step = 0; step < weakScalingSteps; step++ ) {
+        stepSegment( segment, run.boundary, run.deltaTime, run.dampingCoefficient );
+    }
+    MPI_Barrier( MPI_COMM_WORLD );
+    const double wallTime = MPI_Wtime() - start;
+
+    double haloTime;
+    MPI_Reduce( &segment.haloTime, &haloTime, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD );
+    if( rank == 0 ) {
+        const std::string fileName = run.outputDirectory + "/WeakScaling.dat";
+        const bool        newFile  = !std::filesystem::exists( fileName );
+        std::ofstream     results( fileName, std::ios::app );
+        if( !results ) {
+            std::cerr << std::format( "Error: could not open file, {}\n\n", fileName );
+            return EXIT_FAILURE;
+        }
+        if( newFile ) {
+            results << "ranks\tpoints\tsteps\twall (s)\tstep (s)\tpoint updates/s\thalo wait (s)\n";
+        }
+        const std::string row = std::format( "{}\t{}\t{}\t{:.4f}\t{:.4e}\t{:.4e}\t{:.4f}\n", ranks, run.numberOfPoints, weakScalingSteps, wallTime, wallTime / weakScalingSteps, weakScalingSteps * static_cast<double>( run.numberOfPoints ) / wallTime, haloTime );
+        results << row;
+        std::cout << "ranks\tpoints\tsteps\twall (s)\tstep (s)\tpoint updates/s\thalo wait (s)\n" << row;
+        std::cout << std::format( "Added to {}, compare the step time against the run with 1 rank", fileName ) << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,455 @@
+// a sheet of neighbouring field lines from GrandUnifiedModel solved together so waves can couple across L-shells
+// the sheet is indexed by ( shell, point along the line ), each shell is a line traced from its own latitude with the tension
+// and mass from updateTensionMass, points at the same fraction along neighbouring lines are coupled by a transverse term
+// the update is a 2d stencil split into tiles that a pool of threads takes in turn, the rows are fixed size blocks gcc vectorises from -O2
+// the thread count and tile size are timed on the sheet at startup and cached per machine and sheet size in Autotune.dat
+//   FieldLineSheet [shells points]                         shows the sheet, up and down change the steps per frame
+//   FieldLineSheet --benchmark [shells points threads]     times the solver without a window
+
+// includes
+// --------
+
+#define GRAND_UNIFIED_MODEL_NO_MAIN
+#include "GrandUnifiedModel.cpp"
+
+#include <sstream>
+
+// structs
+// -------
+
+struct sheetSolver // shells x points, stored a shell at a time
+{
+    int                shells;
+    int                points;
+    int                tileShells;     // shells in a tile
+    int                tilePoints;     // points in a tile, a tile's rows stay in cache while its neighbours read them
+    double             deltaTime;      // shared by every line, set by the stiffest point (secconds)
+    double             time;           // (secconds)
+    std::vector<float> stringVector;   // displacement
+    std::vector<float> nextString;     // displacement being written this step, swapped with stringVector after it
+    std::vector<float> velocity;
+    std::vector<float> alongCoefficient;  // tension / ( mass * deltaLength^2 ) along each line
+    std::vector<float> acrossCoefficient; // transverse coupling to the neighbouring shells
+};
+
+struct sheetScheduler // persistent threads that share out the tiles of each step
+{
+    sheetSolver             *sheet;
+    std::vector<std::thread> threads;
+    std::mutex               mutex;
+    std::condition_variable  startStep;
+    std::condition_variable  finishStep;
+    long long                generation; // counts the steps handed out, wakes the workers
+    int                      busy;       // workers still on the current step
+    bool                     running;
+    std::atomic<int>         nextTile;
+};
+
+// sheet settings
+// --------------
+
+const double sheetLowestLatitude  = 60.0;  // latitude of the first shell (degrees)
+const double sheetHighestLatitude = 75.0;  // latitude of the last shell (degrees)
+const double sheetCoupling        = 0.05;  // transverse stiffness as a fraction of the stiffness along each line
+const double sheetCourant         = 0.9;   // fraction of the explicit stability limit used for the time step
+const int    sheetTracedShells    = 64;    // field lines traced, the shells between them are interpolated
+const int    sheetTileShells      = 16;    // tile used before autotuning and when it is skipped
+const int    sheetTilePoints      = 1024;
+const int    sheetLanes           = 16;    // points a row is updated in at a time, whole blocks vectorise at -O2 as well as -O3
+const int    sheetBenchmarkSteps  = 200;   // steps timed by --benchmark
+const double sheetTrialTime       = 0.05;  // each autotune candidate is timed for this long (secconds)
+
+const std::string sheetAutotuneFile = defaultScenario().outputDirectory + "/Autotune.dat"; // shared with the jobs' autotuning
+
+// function prototypes
+// -------------------
+
+void initialiseSheet( sheetSolver &sheet, const int shells, const int points, const int threads );
+
+void updateSheetRow( const float *__restrict y, const float *__restrict below, const float *__restrict above, const float *__restrict along, const float *__restrict across, float *__restrict v, float *__restrict next, const int first, const int last, const float dt );
+
+void updateSheetTile( sheetSolver &sheet, const int tile );
+
+void workOnTiles( sheetScheduler &scheduler );
+
+void startScheduler( sheetScheduler &scheduler, sheetSolver &sheet, const int threads );
+
+void stepSheet( sheetScheduler &scheduler );
+
+void stopScheduler( sheetScheduler &scheduler );
+
+int tilesInSheet( const sheetSolver &sheet );
+
+double timeSheet( sheetSolver &sheet, const int threads );
+
+void tuneSheet( sheetSolver &sheet, int &threads );
+
+void uploadSheet( waterfallData &view, const sheetSolver &sheet, std::vector<GLfloat> &pixels );
+
+void processSheetInput( GLFWwindow *window, int &stepsPerFrame );
+
+void sheet_size_callback( GLFWwindow *, int width, int height ); // glfw passes the window, the sheet only has the one
+
+// main
+// ----
+
+int main( int argc, char *argv[] ) {
+    const bool benchmark = argc >= 2 && std::string( argv[1] ) == "--benchmark";
+    const int  first     = benchmark ? 2 : 1;
+    const int  shells    = argc > first ? std::atoi( argv[first] ) : 512;
+    const int  points    = argc > first + 1 ? std::atoi( argv[first + 1] ) : 4096;
+    const bool tune      = argc <= first + 2; // a thread count on the command line skips autotuning
+    int        threads   = tune ? static_cast<int>( std::max( std::thread::hardware_concurrency(), 1u ) ) : std::atoi( argv[first + 2] );
+    if( shells < 3 || points < 3 ) {
+        std::cerr << "Error: the sheet needs at least 3 shells and 3 points\n\n";
+        return EXIT_FAILURE;
+    }
+
+    sheetSolver sheet;
+    auto        start = std::chrono::steady_clock::now();
+    initialiseSheet( sheet, shells, points, threads );
+    std::chrono::duration<double> setupTime = std::chrono::steady_clock::now() - start;
+    std::cout << std::format( "{} shells x {} points, dt {:.3e}s, set up in {:.2f}s on {} threads", shells, points, sheet.deltaTime, setupTime.count(), threads ) << std::endl;
+    if( tune ) {
+        tuneSheet( sheet, threads );
+    }
+
+    sheetScheduler scheduler;
+    startScheduler( scheduler, sheet, threads );
+
+    if( benchmark ) {
+        start = std::chrono::steady_clock::now();
+        for( int step = 0; step < sheetBenchmarkSteps; step++ ) {
+            stepSheet( scheduler );
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        stopScheduler( scheduler );
+        const double stepsPerSecond = sheetBenchmarkSteps / elapsed.count();
+        const float  largest        = std::abs( *std::max_element( sheet.stringVector.begin(), sheet.stringVector.end(), []( float a, float b ) { return std::abs( a ) < std::abs( b ); } ) );
+        std::cout << std::format( "{:.1f} steps/s, {:.3e} point updates/s, largest displacement {:.3f}", stepsPerSecond, stepsPerSecond * shells * points, largest ) << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    // window
+    initialiseGLFW( false );
+    GLFWwindow *window = glfwCreateWindow( 1024, 512, "FieldLineSheet", NULL, NULL );
+    if( window == NULL ) {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent( window );
+    glfwSetFramebufferSizeCallback( window, sheet_size_callback );
+    initialiseGLAD();
+    glViewport( 0, 0, 1024, 512 );
+
+    // the waterfall texture holds the whole sheet, shells up the screen and position along the lines across it
+    waterfallData view;
+    initialiseWaterfall( view, points, shells, 0.0 );
+    std::vector<GLfloat> pixels( view.columns * view.rows );
+
+    int    stepsPerFrame = 1;
+    int    frames        = 0;
+    double lastReport    = glfwGetTime();
+    while( !glfwWindowShouldClose( window ) ) {
+        processSheetInput( window, stepsPerFrame );
+        for( int step = 0; step < stepsPerFrame; step++ ) {
+            stepSheet( scheduler );
+        }
+        uploadSheet( view, sheet, pixels );
+        glClear( GL_COLOR_BUFFER_BIT );
+        renderWaterfall( view );
+        eventSwap( window );
+
+        // frame rate and simulated time once a seccond
+        frames += 1;
+        const double now = glfwGetTime();
+        if( now - lastReport > 1.0 ) {
+            std::cout << std::format( "Time: {:.3f}s, {:.1f} frames/s, {} steps/frame", sheet.time, frames / ( now - lastReport ), stepsPerFrame ) << std::endl;
+            frames     = 0;
+            lastReport = now;
+        }
+    }
+    stopScheduler( scheduler );
+    glfwTerminate();
+    return EXIT_SUCCESS;
+}
+
+// functions
+// ---------
+
+void initialiseSheet( sheetSolver &sheet, const int shells, const int points, const int threads ) {
+    // tracing a line takes a fraction of a seccond, so only sheetTracedShells are traced, shared out over threads the same
+    // way jobs are, and the shells between them interpolate the stiffness, which changes slowly from one L-shell to the next
+    sheet.shells     = shells;
+    sheet.points     = points;
+    sheet.tileShells = sheetTileShells;
+    sheet.tilePoints = sheetTilePoints;
+    sheet.time       = 0.0;
+    sheet.stringVector.assign( shells * points, 0.0f );
+    sheet.velocity.assign( shells * points, 0.0f );
+    sheet.alongCoefficient.assign( shells * points, 0.0f );
+    sheet.acrossCoefficient.assign( shells * points, 0.0f );
+    const int                        traced = std::min( shells, sheetTracedShells );
+    std::vector<std::vector<double>> coefficients( traced );
+
+    std::atomic<int>         nextLine = 0;
+    std::vector<std::thread> workers;
+    for( int worker = 0; worker < std::max( threads, 1 ); worker++ ) {
+        workers.emplace_back( [&]() {
+            std::vector<vec3>   worldPoints;
+            std::vector<double> tension( points, 0.0 );
+            std::vector<double> mass( points, 0.0 );
+            for( int line = nextLine++; line < traced; line = nextLine++ ) {
+                const double latitudeDegrees = sheetLowestLatitude + ( sheetHighestLatitude - sheetLowestLatitude ) * line / ( traced - 1 );
+                const double latitude        = -latitudeDegrees * std::numbers::pi / 180.0;
+                worldPoints.clear();
+                const double length      = lengthOfMagneticFieldLine( latitude, points, worldPoints );
+                const double deltaLength = length / ( points - 1 );
+                updateTensionMass( points, worldPoints, latitude, tension, mass );
+                coefficients[line].resize( points );
+                for( int i = 0; i < points; i++ ) {
+                    coefficients[line][i] = tension[i] / ( mass[i] * deltaLength * deltaLength );
+                }
+            }
+        } );
+    }
+    for( std::thread &worker : workers ) {
+        worker.join();
+    }
+
+    // plucked lines, strongest in the middle shell so the coupling shows as the disturbance spreading
+    const std::vector<double> shape    = createString( points, points - 1.0, 1.0 ); // the gradient is per point, so a length of points - 1 peaks at 1
+    double                    stiffest = 0.0;
+    for( int shell = 0; shell < shells; shell++ ) {
+        const double position = static_cast<double>( shell ) * ( traced - 1 ) / ( shells - 1 );
+        const int    line     = std::min( static_cast<int>( position ), traced - 2 );
+        const double fraction = position - line;
+        const double distance = ( shell - 0.5 * ( shells - 1 ) ) / ( shells / 16.0 );
+        const double envelope = std::exp( -distance * distance );
+        float       *y        = sheet.stringVector.data() + shell * points;
+        float       *along    = sheet.alongCoefficient.data() + shell * points;
+        float       *across   = sheet.acrossCoefficient.data() + shell * points;
+        for( int i = 0; i < points; i++ ) {
+            const double coefficient = ( 1.0 - fraction ) * coefficients[line][i] + fraction * coefficients[line + 1][i];
+            y[i]                     = static_cast<float>( shape[i] * envelope );
+            along[i]                 = static_cast<float>( coefficient );
+            across[i]                = static_cast<float>( sheetCoupling * coefficient );
+            stiffest                 = std::max( stiffest, ( 4.0 + 4.0 * sheetCoupling ) * coefficient );
+        }
+    }
+    // the explicit step is stable while the highest frequency times dt stays under 2
+    sheet.deltaTime  = sheetCourant * 2.0 / std::sqrt( stiffest );
+    sheet.nextString = sheet.stringVector;
+}
+
+int tilesInSheet( const sheetSolver &sheet ) {
+    const int tileRows    = ( sheet.shells + sheet.tileShells - 1 ) / sheet.tileShells;
+    const int tileColumns = ( sheet.points + sheet.tilePoints - 1 ) / sheet.tilePoints;
+    return tileRows * tileColumns;
+}
+
+void updateSheetRow( const float *__restrict y, const float *__restrict below, const float *__restrict above, const float *__restrict along, const float *__restrict across, float *__restrict v, float *__restrict next, const int first, const int last, const float dt ) {
+    // points first to last - 1 of one shell, the restrict parameters let the compiler drop its aliasing checks
+    // and the fixed size blocks need no scalar epilogue, so gcc's -O2 cost model takes them too
+    int i = first;
+    for( ; i + sheetLanes <= last; i += sheetLanes ) {
+        // counted from 0 so the compiler sees sheetLanes iterations
+        for( int lane = 0; lane < sheetLanes; lane++ ) {
+            const int j = i + lane;
+            v[j] += ( along[j] * ( y[j - 1] - 2.0f * y[j] + y[j + 1] ) + across[j] * ( below[j] + above[j] - 2.0f * y[j] ) ) * dt;
+            next[j] = y[j] + v[j] * dt;
+        }
+    }
+    for( ; i < last; i++ ) {
+        v[i] += ( along[i] * ( y[i - 1] - 2.0f * y[i] + y[i + 1] ) + across[i] * ( below[i] + above[i] - 2.0f * y[i] ) ) * dt;
+        next[i] = y[i] + v[i] * dt;
+    }
+}
+
+void updateSheetTile( sheetSolver &sheet, const int tile ) {
+    // reads stringVector and writes nextString so tiles never see each other's half finished points
+    const int tileColumns = ( sheet.points + sheet.tilePoints - 1 ) / sheet.tilePoints;
+    const int firstShell  = ( tile / tileColumns ) * sheet.tileShells;
+    const int lastShell   = std::min( firstShell + sheet.tileShells, sheet.shells );
+    const int firstPoint  = std::max( ( tile % tileColumns ) * sheet.tilePoints, 1 );
+    const int lastPoint   = std::min( ( tile % tileColumns + 1 ) * sheet.tilePoints, sheet.points - 1 );
+    const float dt        = static_cast<float>( sheet.deltaTime );
+    const int   points    = sheet.points;
+    for( int shell = firstShell; shell < lastShell; shell++ ) {
+        // the outer shells have one neighbour, the missing one mirrors the shell itself so its term drops out
+        const int    offset = shell * points;
+        const float *y      = sheet.stringVector.data() + offset;
+        const float *below  = shell > 0 ? y - points : y;
+        const float *above  = shell < sheet.shells - 1 ? y + points : y;
+        updateSheetRow( y, below, above, sheet.alongCoefficient.data() + offset, sheet.acrossCoefficient.data() + offset, sheet.velocity.data() + offset, sheet.nextString.data() + offset, firstPoint, lastPoint, dt );
+    }
+    // the ends of every line are fixed in the ionosphere, so nextString keeps the values it started with
+}
+
+double timeSheet( sheetSolver &sheet, const int threads ) {
+    // steps per seccond with the sheet's current tiles, run for sheetTrialTime on the real sheet
+    sheetScheduler scheduler;
+    startScheduler( scheduler, sheet, threads );
+    long long                     steps = 0;
+    auto                          start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed( 0.0 );
+    while( elapsed.count() < sheetTrialTime || steps < 2 ) {
+        stepSheet( scheduler );
+        steps += 1;
+        elapsed = std::chrono::steady_clock::now() - start;
+    }
+    stopScheduler( scheduler );
+    return steps / elapsed.count();
+}
+
+void tuneSheet( sheetSolver &sheet, int &threads ) {
+    // threads first with the default tile, then the tile with the fastest thread count, the sheet is put back afterwards
+    const std::string key = std::format( "sheet {}x{}", sheet.shells, sheet.points );
+    std::string       cached;
+    if( loadAutotune( sheetAutotuneFile, key, cached ) ) {
+        std::istringstream values( cached );
+        values >> threads >> sheet.tileShells >> sheet.tilePoints;
+        std::cout << std::format( "Autotune: {} threads, {} x {} tiles from {}", threads, sheet.tileShells, sheet.tilePoints, sheetAutotuneFile ) << std::endl;
+        return;
+    }
+    const std::vector<float> stringVector = sheet.stringVector;
+    const std::vector<float> velocity     = sheet.velocity;
+    const double             time         = sheet.time;
+
+    const int hardwareThreads = static_cast<int>( std::max( std::thread::hardware_concurrency(), 1u ) );
+    double    fastest         = 0.0;
+    for( int candidate = 1; candidate <= hardwareThreads; candidate = candidate < hardwareThreads ? std::min( candidate * 2, hardwareThreads ) : candidate + 1 ) {
+        const double rate = timeSheet( sheet, candidate );
+        if( rate > fastest ) {
+            fastest = rate;
+            threads = candidate;
+        }
+    }
+    int bestShells = sheet.tileShells;
+    int bestPoints = sheet.tilePoints;
+    for( int tileShells : { 4, 16, 64 } ) {
+        for( int tilePoints : { 256, 1024, 4096 } ) {
+            sheet.tileShells  = tileShells;
+            sheet.tilePoints  = tilePoints;
+            const double rate = timeSheet( sheet, threads );
+            if( rate > fastest ) {
+                fastest    = rate;
+                bestShells = tileShells;
+                bestPoints = tilePoints;
+            }
+        }
+    }
+    sheet.tileShells = bestShells;
+    sheet.tilePoints = bestPoints;
+
+    sheet.stringVector = stringVector;
+    sheet.nextString   = stringVector;
+    sheet.velocity     = velocity;
+    sheet.time         = time;
+    saveAutotune( sheetAutotuneFile, key, std::format( "{} {} {}", threads, sheet.tileShells, sheet.tilePoints ) );
+    std::cout << std::format( "Autotune: {} threads, {} x {} tiles, {:.1f} steps/s", threads, sheet.tileShells, sheet.tilePoints, fastest ) << std::endl;
+}
+
+void workOnTiles( sheetScheduler &scheduler ) {
+    const int tiles = tilesInSheet( *scheduler.sheet );
+    for( int tile = scheduler.nextTile++; tile < tiles; tile = scheduler.nextTile++ ) {
+        updateSheetTile( *scheduler.sheet, tile );
+    }
+}
+
+void startScheduler( sheetScheduler &scheduler, sheetSolver &sheet, const int threads ) {
+    // the calling thread works on tiles too, so it starts one fewer
+    scheduler.sheet      = &sheet;
+    scheduler.generation = 0;
+    scheduler.busy       = 0;
+    scheduler.running    = true;
+    scheduler.nextTile   = 0;
+    for( int worker = 1; worker < threads; worker++ ) {
+        scheduler.threads.emplace_back( [&scheduler]() {
+            long long seen = 0;
+            while( true ) {
+                {
+                    std::unique_lock<std::mutex> lock( scheduler.mutex );
+                    scheduler.startStep.wait( lock, [&]() { return scheduler.generation != seen || !scheduler.running; } );
+                    if( !scheduler.running ) {
+                        return;
+                    }
+                    seen = scheduler.generation;
+                }
+                workOnTiles( scheduler );
+                std::lock_guard<std::mutex> lock( scheduler.mutex );
+                if( --scheduler.busy == 0 ) {
+                    scheduler.finishStep.notify_one();
+                }
+            }
+        } );
+    }
+}
+
+void stepSheet( sheetScheduler &scheduler ) {
+    {
+        std::lock_guard<std::mutex> lock( scheduler.mutex );
+        scheduler.nextTile = 0;
+        scheduler.busy     = static_cast<int>( scheduler.threads.size() );
+        scheduler.generation += 1;
+    }
+    scheduler.startStep.notify_all();
+    workOnTiles( scheduler );
+    {
+        std::unique_lock<std::mutex> lock( scheduler.mutex );
+        scheduler.finishStep.wait( lock, [&]() { return scheduler.busy == 0; } );
+    }
+    std::swap( scheduler.sheet->stringVector, scheduler.sheet->nextString );
+    scheduler.sheet->time += scheduler.sheet->deltaTime;
+}
+
+void stopScheduler( sheetScheduler &scheduler ) {
+    {
+        std::lock_guard<std::mutex> lock( scheduler.mutex );
+        scheduler.running = false;
+    }
+    scheduler.startStep.notify_all();
+    for( std::thread &thread : scheduler.threads ) {
+        thread.join();
+    }
+    scheduler.threads.clear();
+}
+
+void uploadSheet( waterfallData &view, const sheetSolver &sheet, std::vector<GLfloat> &pixels ) {
+    // samples each shell down to the texture width, the colour scale follows the largest displacement seen so far
+    for( int shell = 0; shell < view.rows; shell++ ) {
+        const float *y = sheet.stringVector.data() + shell * sheet.points;
+        for( int i = 0; i < view.columns; i++ ) {
+            const int index                  = static_cast<int>( static_cast<long long>( i ) * ( sheet.points - 1 ) / std::max( view.columns - 1, 1 ) );
+            pixels[shell * view.columns + i] = y[index];
+            view.amplitude                   = std::max( view.amplitude, std::abs( y[index] ) );
+        }
+    }
+    view.newestRow = view.rows - 1;
+    glBindTexture( GL_TEXTURE_2D, view.texture );
+    glTexSubImage2D( GL_TEXTURE_2D, 0, 0, 0, view.columns, view.rows, GL_RED, GL_FLOAT, pixels.data() );
+}
+
+void processSheetInput( GLFWwindow *window, int &stepsPerFrame ) {
+    // escape closes, up and down double or halve the steps taken each frame
+    static bool upWasPressed   = false;
+    static bool downWasPressed = false;
+    bool        upIsPressed    = glfwGetKey( window, GLFW_KEY_UP ) == GLFW_PRESS;
+    bool        downIsPressed  = glfwGetKey( window, GLFW_KEY_DOWN ) == GLFW_PRESS;
+    if( glfwGetKey( window, GLFW_KEY_ESCAPE ) == GLFW_PRESS ) {
+        glfwSetWindowShouldClose( window, true );
+    }
+    if( upIsPressed && !upWasPressed ) {
+        stepsPerFrame = std::min( stepsPerFrame * 2, 1024 );
+    }
+    if( downIsPressed && !downWasPressed ) {
+        stepsPerFrame = std::max( stepsPerFrame / 2, 1 );
+    }
+    upWasPressed   = upIsPressed;
+    downWasPressed = downIsPressed;
+}
+
+void sheet_size_callback( GLFWwindow *, int width, int height ) {
+    glViewport( 0, 0, width, height );
+}
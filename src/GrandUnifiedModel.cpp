@@ -5,13 +5,137 @@
 #include <GLFW/glfw3.h>
 
 #include <cstdlib>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <cmath>
+#include <complex>
 #include <format>
 #include <fstream>
 #include <vector>
 #include <numbers>
 #include <queue>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <filesystem>
+#include <stdexcept>
+#include <type_traits>
+#include <random>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// vertex streaming
+// ----------------
+
+// glBufferStorage is gl 4.4 / ARB_buffer_storage, so it is loaded by hand rather than relying on the glad profile
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+typedef void( APIENTRYP bufferStorageFunction )( GLenum target, GLsizeiptr size, const void *data, GLbitfield flags );
+
+const int streamRegions = 3; // number of frames the vertex stream can hold at once
+
+const int newFrameBit = 4; // flags an unread frame in the middle slot of a triple buffer
+
+const int captureRegions = 3; // pixel buffers in the offscreen readback ring
+
+const int waterfallMaxColumns = 2048; // widest the waterfall texture gets, longer strings are sampled down to this
+
+enum stringBoundary { fixedEnds, freeEnds, dampedEnds }; // which string update a run uses
+
+enum stringScheme { explicitScheme, crankNicolsonScheme }; // how a run steps the string through time
+
+enum precisionMode { doublePrecision, floatPrecision, floatDoubleAccumulation, floatKahanAccumulation }; // storage and arithmetic of a run
+
+enum stringKernel { referenceKernel, inPlaceKernel, autoKernel }; // which explicit double kernel a job steps with, auto times both
+
+template <precisionMode mode>
+using storageType = std::conditional_t<mode == doublePrecision, double, float>; // what the string is stored as
+
+template <precisionMode mode>
+using workType = std::conditional_t<mode == floatDoubleAccumulation, double, storageType<mode>>; // what each point update is done in
+
+// points the in place kernel updates as one block, each with its own diagnostics sums so the block vectorises,
+// float storage still sums its diagnostics in double per point so it saves memory traffic rather than arithmetic,
+// it is no faster than double unless the string is far out of cache
+const int mixedLanes = 16;
+
+const double energyGrowthLimit = 2.0; // a run is stopped as unstable once its energy grows past this multiple of the first step's
+
+// activity masking
+// -----------------
+
+const int    activityBlockPoints       = 64;    // points in each block of the activity mask
+const double activityThreshold         = 1e-12; // displacement below which a block is quiet, as a fraction of the starting string's largest
+const double activityFullSweepFraction = 0.5;   // fraction of active blocks above which a job goes back to updating every point
+
+const int hudHistory = 240; // frames kept for the frame time percentiles and graph
+
+const int fieldLineAzimuthalMode = 1; // azimuthal wave number used to spread one simulated line across the bundle
+
+// audio
+// -----
+
+const int    resamplerPhases        = 128;  // filter phases per input sample, outputs between two phases are blended
+const double resamplerZeroCrossings = 16.0; // sinc zero crossings each side of the centre tap, more is sharper and slower
+const double resamplerPassband      = 0.9;  // cutoff as a fraction of the lower nyquist rate, leaves room for the transition band
+const double audioHighPassFrequency = 10.0; // takes the string's offset out of the audio (hertz)
+const int    audioBlockFrames       = 4096; // audio frames gathered before each write
+
+// boundary driving
+// ----------------
+
+const int driveChunkFrames     = 4096; // input frames the reader thread parses into each chunk
+const int driveReadAheadChunks = 8;    // chunks the reader keeps ready ahead of the job, it waits once this many are queued
+
+// probes
+// ------
+
+const int probeBlockFrames = 8192; // frames each probe buffers before a block is written to Probes.bin
+
+// autotune
+// --------
+
+const double autotuneSafety    = 0.9;  // fraction of the largest stable explicit time step taken by deltaTime = auto
+const double autotuneTrialTime = 0.1;  // each candidate is timed on the real string for this long (secconds)
+
+std::mutex autotuneMutex; // the cache is shared by jobs running at the same time, so reads and writes take turns
+
+// history
+// -------
+
+const double      historyInterval        = 0.05; // simulated time between frames appended to the history file (secconds)
+const std::size_t historyHeaderBytes     = 24;   // "GUMH", int32 number of points, float64 historyInterval, int64 frames in the ring
+const long long   historyPrefetchFrames  = 64;   // frames ahead of the playback position the kernel is told to read in
+const long long   historyOverwriteMargin = 64;   // frames kept back from the oldest so playback doesnt show one being overwritten
+const std::size_t historyQueueFrames     = 64;   // records the solver can get ahead of the history thread before it waits
+
+// tracing
+// -------
+
+// building with -DWAVES_TRACING records scoped zones and saves them as a chrome trace, open it in chrome://tracing or ui.perfetto.dev
+// without it every TRACE_ macro expands to nothing so the hot paths are unchanged
+#ifdef WAVES_TRACING
+const int traceCapacity = 1 << 20; // events kept per thread, the oldest are overwritten once it is full
+#define TRACE_CONCAT_( a, b ) a##b
+#define TRACE_CONCAT( a, b ) TRACE_CONCAT_( a, b )
+#define TRACE_ZONE( name ) traceZone TRACE_CONCAT( traceZone, __LINE__ )( name )
+#define TRACE_THREAD( name ) nameTraceThread( name )
+#define TRACE_SAVE( fileName ) saveTrace( fileName )
+#else
+#define TRACE_ZONE( name )
+#define TRACE_THREAD( name )
+#define TRACE_SAVE( fileName )
+#endif
 
 // structs
 // -------
@@ -22,14 +146,364 @@ struct point // vec2 but for GLfloats
     GLfloat y;
 };
 
+struct streamBuffer // fixed size buffer of string y values split into regions so a new frame never overwrites one the gpu is drawing
+{
+    GLfloat             *mapped;                // persistent mapping of every region, null when falling back to glBufferSubData
+    std::vector<GLfloat> staging;               // cpu copy of a frame for the glBufferSubData fallback
+    GLsync               fences[streamRegions]; // signalled once the gpu has finished drawing each region
+    int                  region;                // region the next frame is written to
+    int                  drawRegion;            // region holding the latest frame
+    int                  numberOfPoints;        // points per region
+    unsigned int         VBO;
+};
+
+struct stringDiagnostics // sums gathered by the update kernels in the same pass as the update
+{
+    double kineticEnergy;   // sum of ( mass / tension ) * v^2 * dx / 2, the string equation conserves this rather than mass * v^2 as tension varies
+    double potentialEnergy; // sum of (dy/dx)^2 * dx / 2 over each segment
+    double dampingLoss;     // energy taken out by the damped ends this step
+    double maxDisplacement; // largest |y| after the step
+};
+
+struct crankNicolsonOperator // factorised implicit step, rebuilt only if the string, boundary or time step changes
+{
+    stringBoundary      boundary;
+    double              deltaTime;       // (secconds)
+    double              damping;         // damping at the ends, 0 unless the ends are damped
+    std::vector<double> coefficient;     // tension / ( mass * deltaLength^2 ) at each point
+    std::vector<double> lower;           // below diagonal of the matrix
+    std::vector<double> upper;           // above diagonal after the forward sweep
+    std::vector<double> inverseDiagonal; // one over each pivot of the forward sweep
+    std::vector<double> rightHandSide;   // working space for each step
+    double              endChange[2];    // how far each fixed end is moved over the next step, only driven ends move
+};
+
+struct activityMask // blocks of the string that can have moved, jobs only update these while a disturbance is localised
+{
+    int               blocks;
+    int               margin;       // blocks the active region widens by each step, covers the fastest wave speed times dt
+    double            threshold;    // displacement below which a block counts as quiet (meters)
+    bool              fullSweep;    // set once the string is broadly excited, every point is updated from then on
+    std::vector<char> active;       // blocks updated next step
+    std::vector<char> busy;         // blocks above the threshold after the last step
+    long long         pointUpdates; // points actually updated, for the speed up over full sweeps
+};
+
+struct scenario // everything that describes a run, read from a scenario file so experiments dont need a recompile
+{
+    std::string         name;
+    double              latitudeDegrees;  // latitude the field line starts from (degrees)
+    int                 numberOfPoints;   // number of points in the string, can only be odd
+    std::string         shape;            // flat, plucked, pulse or standing
+    double              height;           // amplitude of the initial shape (meters)
+    double              pulseWidth;       // width of the pulse shape (meters)
+    double              pulseStart;       // where the pulse shape starts (meters)
+    int                 mode;             // mode of the standing wave shape
+    stringBoundary      boundary;
+    stringScheme        scheme;           // explicit steps need dt under the wave speed limit, crank nicolson doesnt
+    double              deltaTime;        // delta time between steps (secconds)
+    bool                autoDeltaTime;    // deltaTime = auto, worked out from the wave speed once the line is traced
+    stringKernel        kernel;           // reference, inPlace or auto, only double explicit jobs have a choice
+    double              dampingCoefficient;
+    double              autoSaveTime;     // 0.0 = no auto save (secconds)
+    double              endTime;          // simulated time a job runs for (secconds)
+    double              snapshotInterval; // time between the strings a job buffers for the data file (secconds)
+    std::string         outputDirectory;  // where data is saved, jobs save into a directory named after the scenario inside it
+    precisionMode       precision;        // storage and arithmetic used by headless jobs
+    std::vector<double> pickups;          // positions along the string from 0 to 1 sampled into the audio, empty = no audio
+    double              audioSpeedUp;     // simulated secconds per seccond of audio
+    int                 audioSampleRate;  // (hertz)
+    std::string         audioFormat;      // pcm16, pcm24 or float
+    double              audioGain;        // full scale of the audio as a fraction of the starting string's largest displacement, or the loudest so far when it starts flat
+    bool                sparseUpdates;    // only update the blocks a localised disturbance has reached, explicit scheme only
+    int                 spectrumModes;    // modes in the power law spectrum shape
+    double              spectrumSlope;    // power falls as mode^-spectrumSlope
+    std::uint64_t       spectrumSeed;     // seeds the random phases, the same seed always gives the same string
+    std::vector<double> modeAmplitudes;   // explicit spectrum from mode 1 up, used instead of the power law when given
+    std::vector<double> modePhases;       // phase of each explicit mode, 0 is all displacement and pi/2 all velocity (radians)
+    std::string         driveFile;        // measured time series streamed onto the driven ends, empty = not driven
+    bool                driveFirst;       // the first end follows the time series
+    bool                driveLast;        // the last end follows the time series
+    double              driveInterval;    // time between the samples in the drive file (secconds)
+    double              driveGain;        // displacement of the end per unit in the drive file (meters)
+    std::string         driveInterpolation; // cubic or sinc
+    std::vector<double> probePositions;   // distances along the string recorded into Probes.bin (meters)
+    std::vector<int>    probePoints;      // points recorded into Probes.bin as they are
+    std::string         probeInterpolation; // linear or nearest, how a probe position between two points is read
+    int                 probeEvery;       // steps between probe samples
+    int                 fieldLines;       // lines drawn around the dipole axis in the field line view
+    int                 historyFrames;    // frames the viewer keeps in History.bin, the oldest are overwritten, 0 = no history
+    int                 displacedLines;   // 1 spreads the string round the bundle as an azimuthal mode, more show that many of the latest strings
+    bool                offscreen;        // the viewer saves frames as images instead of showing them
+    double              frameInterval;    // simulated time between offscreen frames (secconds)
+    double              offscreenLength;  // simulated time an offscreen run renders (secconds)
+};
+
+struct jobResult // what a headless job reports back for the summary
+{
+    std::string              name;
+    int                      numberOfPoints;
+    long long                steps;
+    double                   simulatedTime;   // (secconds)
+    double                   wallTime;        // (secconds)
+    bool                     unstable;
+    bool                     failed;
+    double                   updatedFraction; // points updated over points in the string each step, under 1 when sparse updates skip quiet blocks
+    std::vector<std::string> notes;           // warnings from the job, printed by runJobs once it finishes so threads dont interleave them
+};
+
+struct polyphaseResampler // band limited resampler for any ratio, fed one frame at a time so nothing is held beyond its filter
+{
+    int                 channels;
+    int                 taps;     // length of each filter phase
+    double              step;     // input frames per output frame
+    double              position; // time of the next output frame in input frames
+    long long           inputs;   // input frames pushed so far
+    std::vector<double> filter;   // resamplerPhases + 1 rows of taps
+    std::vector<double> history;  // the last taps input frames of each channel, stored twice over
+};
+
+struct wavWriter // streamed wav file, the header sizes are patched when it is closed
+{
+    std::ofstream file;
+    int           channels;
+    int           sampleRate;     // (hertz)
+    int           bytesPerSample; // 2, 3 or 4
+    bool          floatSamples;   // 32 bit float rather than pcm
+    long long     frames;         // frames written so far
+    long long     clipped;        // samples past full scale, pcm clips them and float keeps them
+};
+
+struct sonification // turns pickup points on the string into a wav file as a job runs
+{
+    bool                enabled;
+    std::vector<int>    pickupIndex;    // point before each pickup
+    std::vector<double> pickupFraction; // how far each pickup is towards the next point
+    double              gain;           // displacement to full scale
+    double              audioGain;      // full scale as a fraction of the peak
+    bool                runningPeak;    // the string started flat, so the gain follows the largest output so far
+    double              peak;           // largest dc blocked pickup displacement so far (meters)
+    double              highPass;       // coefficient of the dc blocker
+    std::vector<double> previousInput;  // dc blocker state for each channel, in meters so the gain can change
+    std::vector<double> previousOutput;
+    std::vector<double> frame;          // one input frame
+    std::vector<double> block;          // interleaved output frames waiting to be written
+    polyphaseResampler  resampler;
+    wavWriter           wav;
+};
+
+struct cubicInterpolator // catmull rom onto a finer grid, fed one frame at a time like the resampler
+{
+    int                 channels;
+    double              step;    // input frames per output frame
+    long long           inputs;  // input frames pushed so far
+    long long           outputs; // output frames made so far, output k sits at input time k * step
+    std::vector<double> history; // the last 4 input frames of each channel, stored twice over
+};
+
+struct boundaryDrive // time series read ahead from a file by its own thread and interpolated onto the job's steps
+{
+    bool                            enabled;
+    bool                            driven[2];    // which ends follow the series
+    int                             columns;      // values on each line of the file, 1 moves every driven end alike
+    double                          gain;         // (meters per file unit)
+    bool                            sinc;         // band limited interpolation through the resampler rather than cubic
+    std::ifstream                   file;
+    std::thread                     reader;
+    std::mutex                      mutex;
+    std::condition_variable         condition;
+    std::queue<std::vector<double>> chunks;       // parsed frames waiting for the job, interleaved
+    bool                            finished;     // the reader has reached the end of the file
+    bool                            stopping;     // the job is done, the reader should stop
+    bool                            failed;       // the reader found a line it couldnt read
+    std::string                     error;        // why the drive couldnt start or stopped, for the job's notes
+    std::vector<double>             chunk;        // chunk the job is taking frames from
+    std::size_t                     chunkFrame;   // next frame in chunk
+    bool                            exhausted;    // every frame has been interpolated, the ends are held at rest from here
+    polyphaseResampler              resampler;
+    cubicInterpolator               cubic;
+    std::vector<double>             values;       // interpolated frames, one per step
+    std::size_t                     nextValue;    // next frame in values
+};
+
+struct probeRecorder // a few points of the string at full time resolution, one row per probe so each block is saved as whole series
+{
+    bool                enabled;
+    int                 probes;
+    int                 every;    // steps between samples
+    long long           steps;    // steps seen so far
+    std::vector<int>    index;    // point at or before each probe
+    std::vector<double> fraction; // how far each probe is towards the next point, 0 reads the point as it is
+    std::vector<double> times;    // time of each buffered frame
+    std::vector<double> values;   // probeBlockFrames samples of each probe in turn
+    int                 frames;   // frames buffered since the last block was written
+    std::ofstream       file;
+};
+
 struct bufferData // used to hold the buffered data
 {
     std::vector<double> string;
     double              time;
 };
 
-struct callBackData // used for the call back function to resize the axis ticks
+struct tripleBuffer // lock free handoff of the latest string from the solver thread to the render thread
+{
+    bufferData       slots[3];
+    std::atomic<int> middle;    // slot between the two threads, newFrameBit is set while it holds an unread frame
+    int              writeSlot; // only touched by the solver thread
+    int              readSlot;  // only touched by the render thread
+};
+
+struct solverCounters // only written by the solver thread, read once per report by the render thread
+{
+    std::atomic<long long> steps;          // steps taken since the start
+    std::atomic<double>    solvedTime;     // simulated time reached (secconds)
+    std::atomic<int>       bufferedFrames; // snapshots held for saving
+};
+
+struct historyFile // a ring of frames of the string queued by the solver thread, written by the history thread and mapped by the render thread to scrub through
+{
+    int                             descriptor;     // -1 when the history is off or has failed
+    int                             numberOfPoints;
+    long long                       capacity;       // frames the ring holds, frame f is in slot f % capacity
+    std::size_t                     recordBytes;    // float64 time then the string, so a mapped frame is used as it is
+    std::atomic<long long>          frames;         // frames written, only the history thread adds to it
+    long long                       queued;         // frames handed to the history thread, only used by the solver thread
+    std::mutex                      mutex;
+    std::condition_variable         condition;
+    std::queue<std::vector<double>> pending;        // records waiting to be written
+    bool                            finished;       // no more records are coming
+    std::atomic<bool>               failed;         // a write failed, the history stops there
+    const char                     *map;            // render thread's mapping of the file, NULL until the first frame is shown
+    std::size_t                     mappedBytes;
+    long long                       prefetched;     // frame the last read ahead was from
+};
+
+struct historyPlayback // where the viewer is in the history, only used by the render thread
+{
+    bool      active;   // shows the history rather than the live string
+    double    position; // (secconds)
+    double    rate;     // simulated secconds per real seccond, negative plays backwards
+    long long shown;    // frame on screen, -1 when the live string is
+};
+
+struct solverShared // state shared between the solver thread and the render thread
+{
+    tripleBuffer        frames;
+    historyFile         history;
+    solverCounters      counters;
+    std::atomic<double> targetTime;    // simulated time the solver should have reached (secconds)
+    std::atomic<bool>   saveRequested; // set by the render thread when the save key is pressed
+    std::atomic<bool>   running;       // cleared to stop the solver thread
+    std::atomic<bool>   unstable;      // set by the solver thread when the diagnostics show the run has blown up
+};
+
+struct frameCapture // offscreen framebuffer and a ring of pixel buffers so reading frames back never stalls
+{
+    unsigned int FBO;
+    unsigned int colourRBO;
+    unsigned int depthRBO;
+    unsigned int PBOs[captureRegions];
+    GLsync       fences[captureRegions]; // signalled once each read into a pixel buffer has finished
+    int          next;                   // pixel buffer the next frame is read into
+    int          pending;                // frames read but not yet handed to the writer
+    int          width;
+    int          height;
+};
+
+struct frameWriter // frames waiting to be saved by the writer thread
+{
+    std::mutex                             mutex;
+    std::condition_variable                condition;
+    std::queue<std::vector<unsigned char>> frames;
+    bool                                   finished; // no more frames are coming
+    int                                    width;
+    int                                    height;
+    int                                    written;
+    std::string                            directory;
+};
+
+struct waterfallData // space-time history of the string kept as a ring of rows in a texture
+{
+    unsigned int         texture;
+    unsigned int         VBO;
+    unsigned int         VAO;
+    unsigned int         shaderProgram;
+    int                  newestRowLocation;
+    int                  rowsLocation;
+    int                  amplitudeLocation;
+    int                  columns;   // points across each row
+    int                  rows;      // rows in the ring
+    int                  newestRow; // row written last
+    double               interval;  // simulated time between captured rows (secconds)
+    double               nextTime;  // time of the next captured row (secconds)
+    float                amplitude; // displacement at the ends of the colour map
+    std::vector<GLfloat> row;       // the row being uploaded
+};
+
+struct performanceHud // frame and solver counters, gathered every frame and reported a few times a second
+{
+    std::vector<float> frameTimes;       // ring of recent frame times (secconds)
+    int                nextFrame;        // slot the next frame time goes in
+    int                frames;           // frame times in the ring
+    std::size_t        bytesUploaded;    // bytes sent to the gpu this frame
+    std::size_t        reportBytes;      // bytes sent since the last report
+    int                reportFrames;     // frames since the last report
+    long long          reportSteps;      // solver steps at the last report
+    double             reportSolvedTime; // simulated time at the last report (secconds)
+    double             reportTime;       // wall time of the last report (secconds)
+    std::ofstream     *counters;         // tab separated counter stream, one line per report
+    std::vector<point> graph;            // frame time graph drawn in the corner
+    unsigned int       VBO;
+    unsigned int       VAO;
+    bool               show;
+};
+
+struct fieldLineView // 3d view of a bundle of displaced field lines around the earth
+{
+    unsigned int         lineShaderProgram;
+    unsigned int         sphereShaderProgram;
+    unsigned int         baseVBO; // positions of the undisplaced line, never changes
+    unsigned int         lineVAO;
+    unsigned int         displacementBuffer; // displacement of each distinct line, streamed
+    unsigned int         displacementTexture;
+    unsigned int         sphereVBO;
+    unsigned int         sphereEBO;
+    unsigned int         sphereVAO;
+    int                  sphereIndices;
+    int                  lineColourLocation;
+    int                  lineRotationLocation;
+    int                  lineScaleLocation;
+    int                  exaggerationLocation;
+    int                  sphereColourLocation;
+    int                  sphereRotationLocation;
+    int                  sphereScaleLocation;
+    int                  numberOfPoints; // points along each line
+    int                  numberOfLines;  // lines drawn around the dipole axis
+    int                  displacedLines; // distinct displacement rows, lines past this reuse them
+    int                  newestRow;      // row the latest string went into, older strings are further round the bundle
+    int                  newestRowLocation;
+    float                yaw;            // camera angle about the dipole axis (radians)
+    float                pitch;          // camera angle above the equator (radians)
+    float                zoom;           // screen units per earth radius
+    float                amplitude;      // largest displacement seen so far (meters)
+    bool                 show;
+    std::vector<GLfloat> displacement;
+};
+
+struct levelOfDetail // per pixel column ranges of the string, used to draw min/max envelopes of very long strings
+{
+    std::vector<int>     columnStart;    // first point of each column, the last entry is the final point
+    int                  columns;        // 0 when every point is drawn
+    int                  numberOfPoints; // points in the full string
+    bool                 changed;        // set on resize so the next frame is rebuilt
+    std::vector<double>  previous;       // string each column's envelope was last built from
+    std::vector<GLfloat> envelope;       // min and max of each column from the last build
+};
+
+struct callBackData // used for the call back function to resize the axis ticks and level of detail
 {
+    levelOfDetail *lod;
     point       *axisTicks;
     unsigned int axisTicksVBO;
     int          numberOfTicksOnAxis;
@@ -43,6 +517,31 @@ struct vec3 // vec3 like in c#
     double z;
 };
 
+#ifdef WAVES_TRACING
+struct traceEvent // one finished zone
+{
+    const char *name;     // must be a string literal, only the pointer is kept
+    long long   start;    // nanoseconds since the trace started
+    long long   duration; // nanoseconds
+};
+
+struct traceBuffer // events from a single thread, only that thread writes to it so recording never takes a lock
+{
+    std::vector<traceEvent>  events;
+    std::atomic<long long>   recorded; // events recorded, the latest traceCapacity of them are in events
+    int                      threadId;
+    const char              *threadName;
+};
+
+struct traceZone // records the time between being created and going out of scope
+{
+    const char *name;
+    long long   start;
+    traceZone( const char *zoneName );
+    ~traceZone();
+};
+#endif
+
 // string function prototypes
 // --------------------------
 
@@ -54,11 +553,47 @@ std::vector<double> createString( const int numberOfPoints, const double length,
 
 std::vector<double> createString( const int numberOfPoints, const int mode, const double height ); // standing wave string
 
-void updateFixedString( std::vector<double> &stringVector, std::vector<double> &velocity, const std::vector<double> &mass, const int numberOfPoints, const std::vector<double> &tension, const double deltaLength, const double deltaTime );
+void fourierTransform( std::vector<std::complex<double>> &values );
+
+void radixTwoTransform( std::vector<std::complex<double>> &values, const bool inverse );
+
+void sineTransform( std::vector<double> &values );
+
+void synthesiseSpectrum( const scenario &run, const std::vector<double> &tension, const std::vector<double> &mass, const double deltaLength, std::vector<double> &stringVector, std::vector<double> &velocity );
+
+void updateFixedString( std::vector<double> &stringVector, std::vector<double> &velocity, const std::vector<double> &mass, const int numberOfPoints, const std::vector<double> &tension, const double deltaLength, const double deltaTime, stringDiagnostics &diagnostics );
+
+void updateFreeString( std::vector<double> &stringVector, std::vector<double> &velocity, const std::vector<double> &mass, const int numberOfPoints, const std::vector<double> &tension, const double deltaLength, const double deltaTime, stringDiagnostics &diagnostics );
+
+void updateFreeDispersiveString( std::vector<double> &stringVector, std::vector<double> &velocity, const std::vector<double> &mass, const int numberOfPoints, const std::vector<double> &tension, const double deltaLength, const double deltaTime, const double dampingCoefficient, stringDiagnostics &diagnostics );
+
+void updateString( const stringBoundary boundary, std::vector<double> &stringVector, std::vector<double> &velocity, const std::vector<double> &mass, const int numberOfPoints, const std::vector<double> &tension, const double deltaLength, const double deltaTime, const double dampingCoefficient, stringDiagnostics &diagnostics );
+
+void factoriseCrankNicolson( crankNicolsonOperator &implicitOperator, const stringBoundary boundary, const std::vector<double> &mass, const int numberOfPoints, const std::vector<double> &tension, const double deltaLength, const double deltaTime, const double dampingCoefficient );
+
+void updateCrankNicolsonString( crankNicolsonOperator &implicitOperator, std::vector<double> &stringVector, std::vector<double> &velocity, const std::vector<double> &mass, const int numberOfPoints, const std::vector<double> &tension, const double deltaLength, stringDiagnostics &diagnostics );
 
-void updateFreeString( std::vector<double> &stringVector, std::vector<double> &velocity, const std::vector<double> &mass, const int numberOfPoints, const std::vector<double> &tension, const double deltaLength, const double deltaTime );
+bool isUnstable( const stringDiagnostics &diagnostics, const long long steps, double &initialEnergy );
 
-void updateFreeDispersiveString( std::vector<double> &stringVector, std::vector<double> &velocity, const std::vector<double> &mass, const int numberOfPoints, const std::vector<double> &tension, const double deltaLength, const double deltaTime, const double dampingCoefficient );
+template <precisionMode mode>
+workType<mode> updateMixedEnd( storageType<mode> *y, storageType<mode> *v, const storageType<mode> *k, const storageType<mode> *w, const int end, const int inside, const workType<mode> dt, const workType<mode> damping, const double deltaTime, double &kinetic, double &loss );
+
+template <precisionMode mode>
+inline void updateMixedPoint( storageType<mode> *__restrict y, storageType<mode> *__restrict v, storageType<mode> *__restrict c, const storageType<mode> *__restrict k, const storageType<mode> *__restrict w, const int i, const workType<mode> previous, const workType<mode> current, const workType<mode> next, const workType<mode> dt, double &kinetic, double &potential, double &largest );
+
+template <precisionMode mode>
+void updateMixedInterior( storageType<mode> *y, storageType<mode> *v, storageType<mode> *c, const storageType<mode> *k, const storageType<mode> *w, const workType<mode> dt, const int first, const int end, double &kinetic, double &potential, double &largest );
+
+template <precisionMode mode>
+void updateMixedString( const stringBoundary boundary, std::vector<storageType<mode>> &stringVector, std::vector<storageType<mode>> &velocity, std::vector<storageType<mode>> &compensation, const std::vector<storageType<mode>> &coefficient, const std::vector<storageType<mode>> &weight, const int numberOfPoints, const double deltaTime, const double dampingCoefficient, stringDiagnostics &diagnostics );
+
+template <precisionMode mode>
+void initialiseActivityMask( activityMask &mask, const std::vector<storageType<mode>> &stringVector, const std::vector<storageType<mode>> &velocity, const std::vector<storageType<mode>> &coefficient, const int numberOfPoints, const double deltaTime );
+
+void widenActivityMask( activityMask &mask );
+
+template <precisionMode mode>
+void updateActiveString( activityMask &mask, const stringBoundary boundary, std::vector<storageType<mode>> &stringVector, std::vector<storageType<mode>> &velocity, std::vector<storageType<mode>> &compensation, const std::vector<storageType<mode>> &coefficient, const std::vector<storageType<mode>> &weight, const int numberOfPoints, const double deltaTime, const double dampingCoefficient, stringDiagnostics &diagnostics );
 
 // magnetic dipole function prototypes
 // -----------------------------------
@@ -86,26 +621,205 @@ void pushToBuffer( std::queue<bufferData> &buffer, const std::vector<double> &st
 
 void writeToFile( std::queue<bufferData> buffer, std::ofstream &data, const double deltaLength );
 
-void checkWaveSpeed( std::vector<double> &tension, std::vector<double> &mass, const double deltaTime, const double length, const int numberOfPoints );
+void initialiseTripleBuffer( tripleBuffer &frames, const std::vector<double> &stringVector, const double time );
+
+void publishFrame( tripleBuffer &frames );
+
+bool acquireFrame( tripleBuffer &frames );
+
+void solveString( solverShared &shared, std::vector<double> &stringVector, std::vector<double> &velocity, const std::vector<double> &mass, const std::vector<double> &tension, const int numberOfPoints, const double deltaLength, const double deltaTime, const stringBoundary boundary, const stringScheme scheme, const double dampingCoefficient, double autoSaveTime, std::queue<bufferData> &buffer, std::ofstream &data, std::ofstream &diagnosticsData );
+
+void writeDiagnostics( std::ofstream &diagnosticsData, const stringDiagnostics &diagnostics, const double time, const double dampingLoss );
+
+std::string checkWaveSpeed( const std::vector<double> &tension, const std::vector<double> &mass, const double deltaTime, const double length, const int numberOfPoints ); // empty when the step is stable
+
+// scenario function prototypes
+// ----------------------------
+
+scenario defaultScenario();
+
+std::string trim( const std::string &text );
+
+std::vector<double> parseList( const std::string &value );
+
+void setScenarioValue( scenario &run, const std::string &key, const std::string &value );
+
+std::vector<scenario> loadScenarios( const std::string &fileName );
+
+std::vector<double> createScenarioString( const scenario &run, const double length );
+
+void runJob( const scenario &run, jobResult &result );
+
+template <precisionMode mode>
+void solveJob( const scenario &run, std::vector<double> &stringVector, const std::vector<double> &initialVelocity, const std::vector<double> &tension, const std::vector<double> &mass, const double deltaLength, std::ofstream &data, std::ofstream &diagnosticsData, jobResult &result );
+
+void tuneJobs( const std::vector<scenario> &scenarios );
+
+void runJobs( const std::vector<scenario> &scenarios, const int threads );
+
+// history function prototypes
+// ---------------------------
+
+bool openHistory( historyFile &history, const std::string &fileName, const int numberOfPoints, const long long capacity );
+
+void queueHistory( historyFile &history, const std::vector<double> &stringVector, const double time );
+
+void writeHistory( historyFile &history );
+
+void finishHistory( historyFile &history );
+
+long long firstHistoryFrame( const historyFile &history, const long long frames );
+
+bool mapHistory( historyFile &history );
+
+const double *historyFrame( const historyFile &history, const long long frame );
+
+void prefetchHistory( historyFile &history, const long long frame, const int direction );
+
+void closeHistory( historyFile &history );
+
+// autotune function prototypes
+// ----------------------------
+
+double stableDeltaTime( const std::vector<double> &tension, const std::vector<double> &mass, const double deltaLength, const int numberOfPoints, const stringBoundary boundary, const double dampingCoefficient );
+
+std::string autotuneMachine();
+
+bool loadAutotune( const std::string &fileName, const std::string &key, std::string &value );
+
+void saveAutotune( const std::string &fileName, const std::string &key, const std::string &value );
+
+stringKernel tuneKernel( const scenario &run, const std::vector<double> &stringVector, const std::vector<double> &tension, const std::vector<double> &mass, const double deltaLength, std::vector<std::string> &notes );
+
+// audio function prototypes
+// -------------------------
+
+void initialiseResampler( polyphaseResampler &resampler, const int channels, const double inputRate, const double outputRate );
+
+void pushResampler( polyphaseResampler &resampler, const double *frame, std::vector<double> &output );
+
+bool openWav( wavWriter &wav, const std::string &fileName, const int channels, const int sampleRate, const std::string &format );
+
+void writeWavFrames( wavWriter &wav, const std::vector<double> &samples );
+
+void closeWav( wavWriter &wav );
+
+bool initialiseSonification( sonification &sound, const scenario &run, const std::vector<double> &stringVector, const std::string &fileName );
+
+template <typename real>
+void pushSonification( sonification &sound, const std::vector<real> &stringVector );
+
+void closeSonification( sonification &sound );
+
+// probe function prototypes
+// -------------------------
+
+void checkProbes( const scenario &run, const double length );
+
+bool initialiseProbes( probeRecorder &recorder, const scenario &run, const double deltaLength, const std::string &fileName );
+
+template <typename real>
+void recordProbes( probeRecorder &recorder, const std::vector<real> &stringVector, const double time );
+
+void writeProbeBlock( probeRecorder &recorder );
+
+void closeProbes( probeRecorder &recorder );
+
+// boundary driving function prototypes
+// ------------------------------------
+
+void initialiseCubic( cubicInterpolator &cubic, const int channels, const double inputRate, const double outputRate );
+
+void pushCubic( cubicInterpolator &cubic, const double *frame, std::vector<double> &output );
+
+bool initialiseDrive( boundaryDrive &drive, const scenario &run );
+
+void readDrive( boundaryDrive &drive );
+
+bool nextDriveFrame( boundaryDrive &drive, double *ends );
+
+template <typename real>
+void holdDrivenEnds( const boundaryDrive &drive, std::vector<real> &stringVector, std::vector<real> &velocity, const double *ends, const double *previousEnds, const double deltaTime );
+
+void closeDrive( boundaryDrive &drive );
+
+// tracing function prototypes
+// ---------------------------
+
+#ifdef WAVES_TRACING
+long long traceNow();
+
+traceBuffer &threadTraceBuffer();
+
+void nameTraceThread( const char *name );
+
+void saveTrace( const std::string &fileName );
+#endif
 
 // opengl function prototypes
 // --------------------------
 
-void initialiseGLFW();
+void initialiseGLFW( const bool offscreen );
 
 void initialiseGLAD();
 
-void initialiseShaders( unsigned int &vertexShader, unsigned int &fragmentShader, unsigned int &shaderProgram, int &colour );
+void initialiseShaders( const char *vertexSource, const char *fragmentSource, unsigned int &vertexShader, unsigned int &fragmentShader, unsigned int &shaderProgram, int &colour );
+
+void initialiseVboVao( unsigned int &VBO, unsigned int &VAO, streamBuffer &stream, const int numberOfPoints, unsigned int &shaderProgram );
+
+GLfloat *beginStreamWrite( streamBuffer &stream );
+
+void endStreamWrite( streamBuffer &stream );
 
-void initialiseVboVao( unsigned int &VBO, unsigned int &VAO, point *graph, unsigned int &shaderProgram );
+void fenceStream( streamBuffer &stream );
+
+void convertToFloat( const double *__restrict source, GLfloat *__restrict destination, const int count );
+
+void makeLevelOfDetail( levelOfDetail &lod, const int numberOfPoints, const int width );
+
+int buildEnvelope( levelOfDetail &lod, const double *__restrict source, GLfloat *__restrict destination );
 
 void initialiseAxesVboVao( unsigned int &axesVBO, unsigned int &axesVAO, point *axes, unsigned int &shaderProgram );
 
 void initialiseAxisTicksVboVao( unsigned int &axisTicksVBO, unsigned int &axisTicksVAO, point *axisTicks, unsigned int &shaderProgram, const int numberOfTicks );
 
-void processInput( GLFWwindow *window, float &updateSpeed, bool &saveData );
+void processInput( GLFWwindow *window, float &updateSpeed, bool &saveData, bool &showWaterfall, bool &showHud, fieldLineView &view, const double frameTime );
+
+bool processHistoryInput( GLFWwindow *window, historyPlayback &playback, const float updateSpeed, const double frameTime, const double earliestTime, const double latestTime );
+
+void initialiseFrameCapture( frameCapture &capture, const int width, const int height );
+
+void captureFrame( frameCapture &capture, frameWriter &writer );
+
+void collectFrame( frameCapture &capture, frameWriter &writer );
+
+void finishFrameCapture( frameCapture &capture, frameWriter &writer );
 
-void rendering( unsigned int &shaderProgram, unsigned int &VAO, unsigned int &axesVAO, unsigned int &axisTicksVAO, const int numberOfPoints, int colourLocation, const int numberOfticks );
+void queueFrame( frameWriter &writer, std::vector<unsigned char> &&pixels );
+
+void writeFrames( frameWriter &writer );
+
+void initialiseWaterfall( waterfallData &waterfall, const int numberOfPoints, const int rows, const double interval );
+
+bool pushWaterfallRow( waterfallData &waterfall, const std::vector<double> &stringVector, const double time );
+
+void renderWaterfall( waterfallData &waterfall );
+
+void initialiseFieldLineView( fieldLineView &view, const std::vector<vec3> &worldPoints, const int numberOfPoints, const int numberOfLines, const int displacedLines );
+
+void initialiseHud( performanceHud &hud, std::ofstream &counters );
+
+void recordFrame( performanceHud &hud, const double frameTime );
+
+std::string reportCounters( performanceHud &hud, const solverCounters &counters, const double currentTime, const double lag, const int writerQueue );
+
+void renderHud( performanceHud &hud, unsigned int &shaderProgram, int colourLocation, const int width, const int height );
+
+void updateFieldLineView( fieldLineView &view, const double *stringVector );
+
+void renderFieldLineView( fieldLineView &view, const int width, const int height );
+
+void rendering( unsigned int &shaderProgram, unsigned int &stringShaderProgram, unsigned int &VAO, unsigned int &axesVAO, unsigned int &axisTicksVAO, const int firstPoint, const int numberOfVertices, const int verticesPerPoint, int colourLocation, int stringColourLocation, int firstPointLocation, int pointsLocation, int verticesPerPointLocation, const int numberOfticks );
 
 void eventSwap( GLFWwindow *window );
 
@@ -122,6 +836,18 @@ const char *vertexShaderSource =
     "    gl_Position = vec4(aPos.x, aPos.y, aPos.z, 1.0);\n"
     "}\0";
 
+const char *stringVertexShaderSource = 
+    "#version 330 core\n"
+    "layout (location = 0) in float aY;\n"
+    "uniform int numberOfPoints;\n"
+    "uniform int firstPoint;\n"
+    "uniform int verticesPerPoint;\n"
+    "void main() {\n"
+    "    int index = (gl_VertexID - firstPoint) / verticesPerPoint;\n"
+    "    float x = float(index) / (float(numberOfPoints - 1) / 2.0) - 1.0;\n"
+    "    gl_Position = vec4(x, aY, 0.0, 1.0);\n"
+    "}\0";
+
 const char *fragmentShaderSource = 
     "#version 330 core\n"
     "out vec4 FragColor;\n"
@@ -129,6 +855,73 @@ const char *fragmentShaderSource =
     "void main() {\n"
     "   FragColor = vec4( colour, 1.0f);\n"
     "}\0";
+
+const char *waterfallVertexShaderSource = 
+    "#version 330 core\n"
+    "layout (location = 0) in vec2 aPos;\n"
+    "out vec2 texCoord;\n"
+    "void main() {\n"
+    "    texCoord = aPos * 0.5 + 0.5;\n"
+    "    gl_Position = vec4(aPos, 0.0, 1.0);\n"
+    "}\0";
+
+const char *waterfallFragmentShaderSource = 
+    "#version 330 core\n"
+    "in vec2 texCoord;\n"
+    "out vec4 FragColor;\n"
+    "uniform sampler2D history;\n"
+    "uniform float newestRow;\n"
+    "uniform float rows;\n"
+    "uniform float amplitude;\n"
+    "void main() {\n"
+    "    float row = newestRow - (1.0 - texCoord.y) * (rows - 1.0);\n"
+    "    float value = clamp(texture(history, vec2(texCoord.x, (row + 0.5) / rows)).r / amplitude, -1.0, 1.0);\n"
+    "    vec3 colour = value > 0.0 ? mix(vec3(1.0), vec3(0.8, 0.1, 0.1), value) : mix(vec3(1.0), vec3(0.1, 0.2, 0.8), -value);\n"
+    "    FragColor = vec4(colour, 1.0f);\n"
+    "}\0";
+
+const char *fieldLineVertexShaderSource = 
+    "#version 330 core\n"
+    "layout (location = 0) in vec3 aPos;\n"
+    "uniform samplerBuffer displacement;\n"
+    "uniform int numberOfPoints;\n"
+    "uniform int numberOfLines;\n"
+    "uniform int displacedLines;\n"
+    "uniform int newestRow;\n"
+    "uniform float azimuthalMode;\n"
+    "uniform float exaggeration;\n"
+    "uniform mat3 rotation;\n"
+    "uniform vec2 scale;\n"
+    "void main() {\n"
+    "    float phi = 6.28318530718 * float(gl_InstanceID) / float(numberOfLines);\n"
+    "    int row = (newestRow - gl_InstanceID % displacedLines + displacedLines) % displacedLines;\n"
+    "    float d = texelFetch(displacement, row * numberOfPoints + gl_VertexID).r * exaggeration;\n"
+    "    if (displacedLines == 1) d *= cos(azimuthalMode * phi);\n"
+    "    vec3 p = vec3(aPos.x * cos(phi) - aPos.y * sin(phi) - d * sin(phi), aPos.x * sin(phi) + aPos.y * cos(phi) + d * cos(phi), aPos.z);\n"
+    "    vec3 v = rotation * p;\n"
+    "    gl_Position = vec4(v.x * scale.x, v.z * scale.y, -v.y * 0.02, 1.0);\n"
+    "}\0";
+
+const char *sphereVertexShaderSource = 
+    "#version 330 core\n"
+    "layout (location = 0) in vec3 aPos;\n"
+    "uniform mat3 rotation;\n"
+    "uniform vec2 scale;\n"
+    "out float shade;\n"
+    "void main() {\n"
+    "    vec3 v = rotation * aPos;\n"
+    "    shade = 0.5 + 0.5 * max(-v.y, 0.0);\n"
+    "    gl_Position = vec4(v.x * scale.x, v.z * scale.y, -v.y * 0.02, 1.0);\n"
+    "}\0";
+
+const char *sphereFragmentShaderSource = 
+    "#version 330 core\n"
+    "in float shade;\n"
+    "out vec4 FragColor;\n"
+    "uniform vec3 colour;\n"
+    "void main() {\n"
+    "    FragColor = vec4(colour * shade, 1.0f);\n"
+    "}\0";
 // clang-format on
 
 // global variables
@@ -141,26 +934,59 @@ const double mp           = 1.67e-27;                                       // m
 const double rho0         = 50.0 * mp * 1e6 * pow( 4.0 * radiusEarth, 3 );  // plasma mass density naught, McIlwain parameter > 4
 const double rho02        = 200.0 * mp * 1e6 * pow( 4.0 * radiusEarth, 4 ); // plasma mass density naught, McIlwain parameter <= 4
 
+#ifdef WAVES_TRACING
+const auto                traceStart = std::chrono::steady_clock::now(); // zero time of the trace
+std::mutex                traceMutex;                                   // only taken when a thread records its first event
+std::vector<traceBuffer *> traceBuffers;                                // every thread that has recorded, kept until the trace is saved
+#endif
+
 // main
 // ----
 
-int main() {
+// the benchmarks include this file with GRAND_UNIFIED_MODEL_NO_MAIN defined so they time the same kernels
+#ifndef GRAND_UNIFIED_MODEL_NO_MAIN
+int main( int argc, char *argv[] ) {
+    TRACE_THREAD( "render" );
+    // scenario, "GrandUnifiedModel file.ini" shows the first scenario in the file
+    // "GrandUnifiedModel --jobs file.ini [threads]" runs every scenario in the file headless across the cores
+    scenario run = defaultScenario();
+    if( argc >= 3 && std::string( argv[1] ) == "--jobs" ) {
+        int threads = argc >= 4 ? std::atoi( argv[3] ) : static_cast<int>( std::thread::hardware_concurrency() );
+        runJobs( loadScenarios( argv[2] ), threads );
+        return EXIT_SUCCESS;
+    }
+    if( argc >= 2 ) {
+        run = loadScenarios( argv[1] ).front();
+    }
+    if( !run.driveFile.empty() ) {
+        std::cout << std::format( "Note: {} is driven from {}, only --jobs drive the ends", run.name, run.driveFile ) << std::endl;
+    }
+    const std::string outputPath = run.outputDirectory + "/";
+    std::filesystem::create_directories( run.outputDirectory );
+
     // system variables
-    const double      latitudeDegrees = 70.0;                                                      // latitude in degrees
-    const double      latitude        = -latitudeDegrees * std::numbers::pi / 180.0;               // latitude in radians
-    const int         numberOfPoints  = 1001;                                                      // number of points in the string, can only be odd
+    const double      latitude       = -run.latitudeDegrees * std::numbers::pi / 180.0;            // latitude in radians
+    const int         numberOfPoints = run.numberOfPoints;                                         // number of points in the string, can only be odd
     std::vector<vec3> worldPoints;                                                                 // The in world, on earth, location of the points
     const double      length = lengthOfMagneticFieldLine( latitude, numberOfPoints, worldPoints ); // length of the string in the x direction (meters)
-    const double      height = 1.0;                                                                // amplitude of peaks in the y direction (meters)
 
     // initial shape of string
-    // std::vector<double> stringVector = createString( numberOfPoints, length ); // flat string
-    std::vector<double> stringVector = createString( numberOfPoints, length, height * 100000 ); // plucked string
-    // std::vector<double> stringVector = createString( numberOfPoints, length, height, 5, 50 ); // pulse string
-    // std::vector<double> stringVector = createString( numberOfPoints, 3, height ); // standing wave string
-
+    std::vector<double> stringVector;
+    try {
+        stringVector = createScenarioString( run, length );
+    }
+    catch( const std::invalid_argument &error ) {
+        std::cerr << std::format( "Error: {}, {}\n\n", run.name, error.what() );
+        abort();
+    }
+
+    // offscreen rendering, frames are saved as images at a fixed simulated time step instead of being shown
+    const bool   offscreen       = run.offscreen;
+    const double frameInterval   = run.frameInterval;   // simulated time between saved frames (secconds)
+    const double offscreenLength = run.offscreenLength; // simulated time to render (secconds)
+
     // initialises GLFW
-    initialiseGLFW();
+    initialiseGLFW( offscreen );
 
     // create the window and checks if its opened
     GLFWwindow *window = glfwCreateWindow( 800, 600, "WavesOnStrings", NULL, NULL );
@@ -180,17 +1006,21 @@ int main() {
 
     // file and data saving
     bool          saveData     = false;
-    double        autoSaveTime = 0.0;                      // 0.0 = no auto save (secconds)
+    double        autoSaveTime = run.autoSaveTime;         // 0.0 = no auto save (secconds)
     std::string   fileName     = "WavesOnStringsData.dat"; // name of file to save data to
-    std::ofstream data( "../../data/" + fileName );
+    std::ofstream data( outputPath + fileName );
     if( !data ) {
         std::cerr << format( "Error: could not open file, {}\n\n", fileName );
         abort();
     }
     data << "t\tx\ty\n";
-
-    // holds the string data
-    point graph[numberOfPoints];
+    // per step diagnostics, header is "GUMD" then records of 5 float32 (see writeDiagnostics)
+    std::ofstream diagnosticsData( outputPath + "Diagnostics.bin", std::ios::binary );
+    if( !diagnosticsData ) {
+        std::cerr << std::format( "Error: could not open file, {}\n\n", "Diagnostics.bin" );
+        abort();
+    }
+    diagnosticsData.write( "GUMD", 4 );
 
     // holds the axes
     // clang-format off
@@ -218,7 +1048,15 @@ int main() {
     unsigned int fragmentShader;
     unsigned int shaderProgram;
     int          colourLocation;
-    initialiseShaders( vertexShader, fragmentShader, shaderProgram, colourLocation );
+    initialiseShaders( vertexShaderSource, fragmentShaderSource, vertexShader, fragmentShader, shaderProgram, colourLocation );
+
+    // initialises the string shader, it only needs the y values
+    unsigned int stringShaderProgram;
+    int          stringColourLocation;
+    initialiseShaders( stringVertexShaderSource, fragmentShaderSource, vertexShader, fragmentShader, stringShaderProgram, stringColourLocation );
+    int firstPointLocation       = glGetUniformLocation( stringShaderProgram, "firstPoint" );
+    int pointsLocation           = glGetUniformLocation( stringShaderProgram, "numberOfPoints" );
+    int verticesPerPointLocation = glGetUniformLocation( stringShaderProgram, "verticesPerPoint" );
 
     // initialises axis VBO and VAO
     unsigned int axesVBO;
@@ -230,94 +1068,306 @@ int main() {
     unsigned int axisTicksVAO;
     initialiseAxisTicksVboVao( axisTicksVBO, axisTicksVAO, axisTicks, shaderProgram, numberOfTicks );
 
+    // level of detail, long strings are drawn as a min/max envelope per pixel column
+    levelOfDetail lod;
+    int           framebufferWidth;
+    int           framebufferHeight;
+    glfwGetFramebufferSize( window, &framebufferWidth, &framebufferHeight );
+    makeLevelOfDetail( lod, numberOfPoints, framebufferWidth );
+
     // axis callback data
+    callbackData.lod                 = &lod;
     callbackData.axisTicks           = axisTicks;
     callbackData.axisTicksVBO        = axisTicksVBO;
     callbackData.numberOfTicksOnAxis = numberOfTicksOnAxis;
     callbackData.numberOfTicks       = numberOfTicks;
     glfwSetWindowUserPointer( window, &callbackData );
 
-    // initialises VBO and VAO
+    // initialises VBO and VAO, the string is streamed through a triple buffered VBO
     unsigned int VBO;
     unsigned int VAO;
-    initialiseVboVao( VBO, VAO, graph, shaderProgram );
+    streamBuffer stream;
+    initialiseVboVao( VBO, VAO, stream, numberOfPoints, shaderProgram );
 
     // string variables
     std::vector<double> tension( numberOfPoints, 0.0 );
     std::vector<double> mass( numberOfPoints, 0.0 );
     updateTensionMass( numberOfPoints, worldPoints, latitude, tension, mass );
     const double deltaLength        = length / ( numberOfPoints - 1 ); // the distance between points (meters)
-    const double dampingCoefficient = 1.0;                             // damping coefficient in the free dispersive string
+    const double dampingCoefficient = run.dampingCoefficient;          // damping coefficient in the free dispersive string
     // time variables
-    double time        = 0.0;   // time (secconds)
-    double deltaTime   = 0.001; // delta time between steps (secconds)
-    int    intTime     = 0;     // integer time used for buffering data
-    double realTime    = 0.0;   // the in world real time that has passed
-    float  updateSpeed = 1.0;   // the speed at which the string is updated
-    checkWaveSpeed( tension, mass, deltaTime, length, numberOfPoints );
+    double deltaTime   = run.deltaTime; // delta time between steps (secconds)
+    double realTime    = 0.0;           // the in world real time that has passed
+    float  updateSpeed = 1.0;           // the speed at which the string is updated
+    if( run.autoDeltaTime ) {
+        deltaTime = stableDeltaTime( tension, mass, deltaLength, numberOfPoints, run.boundary, dampingCoefficient );
+        std::cout << std::format( "Delta time: {:.3e}s from the wave speed", deltaTime ) << std::endl;
+    }
+    if( run.scheme == explicitScheme ) {
+        std::string warning = checkWaveSpeed( tension, mass, deltaTime, length, numberOfPoints );
+        if( !warning.empty() ) {
+            std::cout << warning << std::endl;
+        }
+    }
     // velocity vector
     std::vector<double> velocity( numberOfPoints, 0.0 );
+    if( run.shape == "spectrum" ) {
+        synthesiseSpectrum( run, tension, mass, deltaLength, stringVector, velocity );
+    }
+
+    // the solver runs on its own thread and hands the latest string over through a triple buffer
+    solverShared shared;
+    initialiseTripleBuffer( shared.frames, stringVector, 0.0 );
+    shared.targetTime    = 0.0;
+    shared.saveRequested = false;
+    shared.running       = true;
+    shared.unstable      = false;
+    shared.counters.steps          = 0;
+    shared.counters.solvedTime     = 0.0;
+    shared.counters.bufferedFrames = 0;
+    // every historyInterval of the run is queued for the history thread, r switches the view to it,
+    // History.bin holds the last historyFrames of them and isnt made at all when that is 0
+    const bool  keepHistory = run.historyFrames > 0;
+    std::thread historyWriter;
+    shared.history.descriptor = -1;
+    if( keepHistory ) {
+        if( !openHistory( shared.history, outputPath + "History.bin", numberOfPoints, run.historyFrames ) ) {
+            std::cerr << std::format( "Error: could not open file, {}\n\n", "History.bin" );
+            abort();
+        }
+        historyWriter = std::thread( writeHistory, std::ref( shared.history ) );
+    }
+    historyPlayback playback;
+    playback.active   = false;
+    playback.position = 0.0;
+    playback.rate     = 0.0;
+    playback.shown    = -1;
+    std::thread solver( solveString, std::ref( shared ), std::ref( stringVector ), std::ref( velocity ), std::cref( mass ), std::cref( tension ), numberOfPoints, deltaLength, deltaTime, run.boundary, run.scheme, dampingCoefficient, autoSaveTime, std::ref( buffer ), std::ref( data ), std::ref( diagnosticsData ) );
+
+    // waterfall view of the string's history, toggled with w
+    bool          showWaterfall = false;
+    waterfallData waterfall;
+    initialiseWaterfall( waterfall, numberOfPoints, 512, 0.05 );
+
+    // performance hud, toggled with h, the counters are always streamed to a file
+    std::ofstream counters( outputPath + "PerformanceCounters.dat" );
+    if( !counters ) {
+        std::cerr << std::format( "Error: could not open file, {}\n\n", "PerformanceCounters.dat" );
+        abort();
+    }
+    performanceHud hud;
+    initialiseHud( hud, counters );
+
+    // 3d view of the displaced field line and a bundle of its neighbours, toggled with v
+    if( run.displacedLines > run.fieldLines ) {
+        std::cerr << std::format( "Error: displacedLines is {} but only {} fieldLines are drawn\n\n", run.displacedLines, run.fieldLines );
+        abort();
+    }
+    fieldLineView view;
+    initialiseFieldLineView( view, worldPoints, numberOfPoints, run.fieldLines, run.displacedLines );
+
+    // offscreen framebuffer and the thread that writes its frames out
+    frameCapture capture;
+    frameWriter  writer;
+    std::thread  writerThread;
+    int          frameNumber = 0; // frames rendered offscreen
+    if( offscreen ) {
+        initialiseFrameCapture( capture, framebufferWidth, framebufferHeight );
+        writer.finished  = false;
+        writer.width     = framebufferWidth;
+        writer.height    = framebufferHeight;
+        writer.written   = 0;
+        writer.directory = outputPath + "frames";
+        std::filesystem::create_directories( writer.directory );
+        writerThread = std::thread( writeFrames, std::ref( writer ) );
+    }
 
     // enables vsync
     glfwSwapInterval( 0 ); // set to 0 as vsync frame time was 0.004
 
+    bool   stringChanged    = true; // the stream only gets a new frame when the solver has published one
+    int    drawnVertices    = 0;    // vertices in the latest frame of the stream
+    int    verticesPerPoint = 1;    // 2 when the latest frame is a min/max envelope
+    double titleTime        = 0.0;  // last time the window title was updated
     while( !glfwWindowShouldClose( window ) ) {
+        TRACE_ZONE( "frame" );
         // frame time calculation
         double        currentTime  = glfwGetTime();
         static double previousTime = currentTime;
         double        frameTime    = currentTime - previousTime;
         previousTime               = currentTime;
 
-        processInput( window, updateSpeed, saveData );
-
-        // auto save
-        if( autoSaveTime != 0.0 && time + 1e-4 > autoSaveTime ) {
-            saveData     = true;
-            autoSaveTime = 0.0;
+        processInput( window, updateSpeed, saveData, showWaterfall, hud.show, view, frameTime );
+        if( keepHistory ) {
+            const long long written = shared.history.frames.load( std::memory_order_acquire );
+            if( processHistoryInput( window, playback, updateSpeed, frameTime, firstHistoryFrame( shared.history, written ) * historyInterval, written * historyInterval ) ) {
+                stringChanged  = true; // back to the live string, or into the history
+                playback.shown = -1;
+            }
         }
 
-        // saving and buffering data
+        // saving is done by the solver thread as it owns the buffered data
         if( saveData ) {
-            saveData = false;
-            writeToFile( buffer, data, deltaLength );
+            saveData             = false;
+            shared.saveRequested = true;
         }
-        else if( !saveData && time + 1e-4 >= intTime ) { // push to buffer every int seccond
-            // buffer data
-            pushToBuffer( buffer, stringVector, time );
-            std::cout << std::format( "Time: {:.1f}s, {:.1f}m", time, time / 60.0 ) << std::endl;
-            intTime += 1;
+
+        // precise time, the solver takes as many steps as it needs to reach this
+        if( offscreen ) {
+            realTime = frameNumber * frameInterval; // frames are a fixed simulated time apart rather than following the clock
         }
+        else {
+            realTime += frameTime * static_cast<double>( updateSpeed );
+        }
+        shared.targetTime.store( realTime, std::memory_order_relaxed );
 
-        // updates string
-        if( realTime + 1e-4 >= time ) {
-            // updateFixedString( stringVector, velocity, mass, numberOfPoints, tension, deltaLength, deltaTime );
-            // updateFreeString( stringVector, velocity, mass, numberOfPoints, tension, deltaLength, deltaTime );
-            updateFreeDispersiveString( stringVector, velocity, mass, numberOfPoints, tension, deltaLength, deltaTime, dampingCoefficient );
-            // copy the data
-            for( int i = 0; i < numberOfPoints; i++ ) {
-                float x    = ( i ) / ( ( numberOfPoints - 1.0 ) / 2.0 );
-                graph[i].x = x - 1;
-                graph[i].y = static_cast<float>( stringVector[i] );
+        // picks up the latest string from the solver
+        if( acquireFrame( shared.frames ) ) {
+            stringChanged = true;
+        }
+        // offscreen frames wait for the solver to reach their time
+        if( offscreen ) {
+            TRACE_ZONE( "wait for solver" );
+            while( !shared.unstable && shared.frames.slots[shared.frames.readSlot].time + 1e-4 < realTime ) {
+                if( acquireFrame( shared.frames ) ) {
+                    stringChanged = true;
+                }
+                else {
+                    std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+                }
+            }
+        }
+        const bufferData &frame = shared.frames.slots[shared.frames.readSlot];
+
+        // history playback shows a mapped frame in place of the live string, nothing is copied or parsed
+        const double *shownString = frame.string.data();
+        double        shownTime   = frame.time;
+        if( playback.active && mapHistory( shared.history ) ) {
+            const long long frames = shared.history.frames.load( std::memory_order_acquire );
+            const long long shown  = std::clamp( std::llround( playback.position / historyInterval ), firstHistoryFrame( shared.history, frames ), frames - 1 );
+            const double   *record = historyFrame( shared.history, shown );
+            shownTime              = record[0];
+            shownString            = record + 1;
+            stringChanged          = playback.shown != shown;
+            if( stringChanged ) {
+                prefetchHistory( shared.history, shown, playback.rate < 0.0 ? -1 : playback.rate > 0.0 ? 1 : 0 );
+                playback.shown = shown;
+            }
+        }
+
+        // the solver has stopped itself, there is nothing more to show
+        if( shared.unstable ) {
+            glfwSetWindowShouldClose( window, true );
+        }
+
+        // shows if the solver is keeping up with the requested speed, or the counters when the hud is shown
+        recordFrame( hud, frameTime );
+        if( currentTime - titleTime > 0.25 ) {
+            double lag         = ( realTime - frame.time ) / static_cast<double>( updateSpeed ); // how far behind in real secconds
+            int    writerQueue = 0;
+            if( offscreen ) {
+                std::lock_guard<std::mutex> lock( writer.mutex );
+                writerQueue = writer.frames.size();
+            }
+            std::string summary = reportCounters( hud, shared.counters, currentTime, lag, writerQueue );
+            if( playback.active ) {
+                glfwSetWindowTitle( window, std::format( "WavesOnStrings - History: {:.2f}s of {:.1f}s, {}x", shownTime, frame.time, playback.rate ).c_str() );
+            }
+            else if( hud.show ) {
+                glfwSetWindowTitle( window, std::format( "WavesOnStrings - {}", summary ).c_str() );
+            }
+            else if( lag < 0.1 ) {
+                glfwSetWindowTitle( window, std::format( "WavesOnStrings - Time: {:.1f}s, {}x, keeping up", frame.time, updateSpeed ).c_str() );
+            }
+            else {
+                glfwSetWindowTitle( window, std::format( "WavesOnStrings - Time: {:.1f}s, {}x, behind by {:.1f}s", frame.time, updateSpeed, lag ).c_str() );
+            }
+            titleTime = currentTime;
+        }
+
+        // adds the new string to the waterfall history and the field line view
+        if( stringChanged ) {
+            if( !playback.active && pushWaterfallRow( waterfall, frame.string, frame.time ) ) {
+                hud.bytesUploaded += waterfall.columns * sizeof( GLfloat );
             }
-            time += deltaTime;
+            if( view.show ) {
+                updateFieldLineView( view, shownString );
+                hud.bytesUploaded += view.numberOfPoints * sizeof( GLfloat );
+            }
+        }
+
+        // converts the string into the next free region of the stream, only done for frames that are drawn
+        if( stringChanged || lod.changed ) {
+            TRACE_ZONE( "graph copy" );
+            if( lod.columns == 0 ) {
+                convertToFloat( shownString, beginStreamWrite( stream ), numberOfPoints );
+                drawnVertices    = numberOfPoints;
+                verticesPerPoint = 1;
+            }
+            else {
+                drawnVertices    = buildEnvelope( lod, shownString, beginStreamWrite( stream ) );
+                verticesPerPoint = 2;
+            }
+            endStreamWrite( stream );
+            hud.bytesUploaded += drawnVertices * sizeof( GLfloat );
+            stringChanged = false;
+            lod.changed   = false;
         }
 
-        // precise time
-        realTime += frameTime * static_cast<double>( updateSpeed );
-        // std::cout << realTime << "\t" << time << std::endl;
+        // draws the latest frame in the stream, above the waterfall when it is shown
+        glfwGetFramebufferSize( window, &framebufferWidth, &framebufferHeight );
+        if( view.show ) {
+            renderFieldLineView( view, framebufferWidth, framebufferHeight );
+        }
+        else if( showWaterfall ) {
+            glViewport( 0, framebufferHeight / 3, framebufferWidth, framebufferHeight - framebufferHeight / 3 );
+        }
+        if( !view.show ) {
+            rendering( shaderProgram, stringShaderProgram, VAO, axesVAO, axisTicksVAO, stream.drawRegion * numberOfPoints, drawnVertices, verticesPerPoint, colourLocation, stringColourLocation, firstPointLocation, pointsLocation, verticesPerPointLocation, numberOfTicks );
+            fenceStream( stream );
+        }
+        if( showWaterfall && !view.show ) {
+            glViewport( 0, 0, framebufferWidth, framebufferHeight / 3 );
+            renderWaterfall( waterfall );
+            glViewport( 0, 0, framebufferWidth, framebufferHeight );
+        }
+        if( hud.show ) {
+            renderHud( hud, shaderProgram, colourLocation, framebufferWidth, framebufferHeight );
+        }
 
-        // save data to the buffer
-        glBindBuffer( GL_ARRAY_BUFFER, VBO );
-        glBufferData( GL_ARRAY_BUFFER, numberOfPoints * sizeof( point ), graph, GL_DYNAMIC_DRAW );
-        rendering( shaderProgram, VAO, axesVAO, axisTicksVAO, numberOfPoints, colourLocation, numberOfTicks );
+        if( offscreen ) {
+            captureFrame( capture, writer );
+            frameNumber += 1;
+            if( realTime >= offscreenLength ) {
+                glfwSetWindowShouldClose( window, true );
+            }
+            glfwPollEvents();
+            continue;
+        }
 
         eventSwap( window );
     }
 
+    shared.running = false;
+    solver.join();
+    if( keepHistory ) {
+        finishHistory( shared.history );
+        historyWriter.join();
+    }
+    closeHistory( shared.history );
+    if( offscreen ) {
+        finishFrameCapture( capture, writer );
+        writerThread.join();
+        std::cout << std::format( "Saved {} frames to {}", writer.written, writer.directory ) << std::endl;
+    }
     glfwTerminate();
     data.close();
+    diagnosticsData.close();
+    counters.close();
+    TRACE_SAVE( outputPath + "Trace.json" );
     return 0;
 }
+#endif
 
 // string functions
 // ----------------
@@ -348,6 +1398,12 @@ std::vector<double> createString( const int numberOfPoints, const double length,
     }
     const int widthPoints           = int( ( width / length ) * ( numberOfPoints - 1.0 ) + 0.5 );          // the width in terms of points on the string
     const int startingLocationPoint = int( ( startingLocation / length ) * ( numberOfPoints - 1 ) + 0.5 ); // starting location in the vector
+    if( widthPoints < 2 ) {
+        throw std::invalid_argument( std::format( "pulseWidth of {:.3e}m is under 2 points, the points are {:.3e}m apart", width, length / ( numberOfPoints - 1 ) ) );
+    }
+    if( startingLocation < 0.0 || startingLocationPoint + widthPoints > numberOfPoints - 1 ) {
+        throw std::invalid_argument( std::format( "pulse from {:.3e}m to {:.3e}m is off the {:.3e}m line", startingLocation, startingLocation + width, length ) );
+    }
     for( int i = startingLocationPoint; i <= startingLocationPoint + widthPoints; i++ ) {
         stringVector.at( i ) = height * signValue * sin( ( i - startingLocationPoint ) * 2.0 * std::numbers::pi / widthPoints );
     }
@@ -364,24 +1420,168 @@ std::vector<double> createString( const int numberOfPoints, const int mode, cons
     return stringVector;
 }
 
-void updateFixedString( std::vector<double> &stringVector, std::vector<double> &velocity, const std::vector<double> &mass, const int numberOfPoints, const std::vector<double> &tension, const double deltaLength, const double deltaTime ) {
+void fourierTransform( std::vector<std::complex<double>> &values ) {
+    // forward transform of any length, powers of two go straight to the radix 2 transform and the rest through
+    // bluestein's chirp z, which turns it into a convolution of a power of two length so every length is n log n
+    const std::size_t size = values.size();
+    if( ( size & ( size - 1 ) ) == 0 ) {
+        radixTwoTransform( values, false );
+        return;
+    }
+    std::size_t padded = 1;
+    while( padded < 2 * size - 1 ) {
+        padded *= 2;
+    }
+    // chirp[n] = exp( i pi n^2 / size ), n^2 is taken mod 2 * size first so large n dont lose the angle
+    std::vector<std::complex<double>> chirp( size );
+    for( std::size_t n = 0; n < size; n++ ) {
+        const unsigned long long square = static_cast<unsigned long long>( n ) * n % ( 2 * size );
+        chirp[n]                        = std::polar( 1.0, std::numbers::pi * square / size );
+    }
+    std::vector<std::complex<double>> a( padded, 0.0 );
+    std::vector<std::complex<double>> b( padded, 0.0 );
+    for( std::size_t n = 0; n < size; n++ ) {
+        a[n] = values[n] * std::conj( chirp[n] );
+    }
+    b[0] = chirp[0];
+    for( std::size_t n = 1; n < size; n++ ) {
+        b[n]          = chirp[n];
+        b[padded - n] = chirp[n];
+    }
+    radixTwoTransform( a, false );
+    radixTwoTransform( b, false );
+    for( std::size_t n = 0; n < padded; n++ ) {
+        a[n] = std::complex<double>( a[n].real() * b[n].real() - a[n].imag() * b[n].imag(), a[n].real() * b[n].imag() + a[n].imag() * b[n].real() );
+    }
+    radixTwoTransform( a, true );
+    for( std::size_t k = 0; k < size; k++ ) {
+        values[k] = a[k] * std::conj( chirp[k] ) / static_cast<double>( padded );
+    }
+}
+
+void radixTwoTransform( std::vector<std::complex<double>> &values, const bool inverse ) {
+    // in place iterative cooley tukey, the inverse is left unscaled
+    // the roots come from a table rather than repeated multiplication so long transforms dont gather rounding error,
+    // and the butterflies multiply out by hand as std::complex's operator checks for infinities on every product
+    const std::size_t                 size = values.size();
+    std::vector<std::complex<double>> roots( size / 2 );
+    for( std::size_t k = 0; k < size / 2; k++ ) {
+        roots[k] = std::polar( 1.0, ( inverse ? 2.0 : -2.0 ) * std::numbers::pi * k / size );
+    }
+    for( std::size_t i = 1, j = 0; i < size; i++ ) {
+        std::size_t bit = size >> 1;
+        for( ; j & bit; bit >>= 1 ) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if( i < j ) {
+            std::swap( values[i], values[j] );
+        }
+    }
+    for( std::size_t length = 2; length <= size; length *= 2 ) {
+        const std::size_t stride = size / length;
+        for( std::size_t start = 0; start < size; start += length ) {
+            for( std::size_t k = 0; k < length / 2; k++ ) {
+                const std::complex<double> root = roots[k * stride];
+                const std::complex<double> even = values[start + k];
+                const std::complex<double> next = values[start + k + length / 2];
+                const std::complex<double> odd( next.real() * root.real() - next.imag() * root.imag(), next.real() * root.imag() + next.imag() * root.real() );
+                values[start + k]              = even + odd;
+                values[start + k + length / 2] = even - odd;
+            }
+        }
+    }
+}
+
+void sineTransform( std::vector<double> &values ) {
+    // values[m] = sum over the modes of values[mode] * sin( pi * mode * m / ( size - 1 ) ), the ends are mode 0 and the
+    // nyquist mode which are always 0, done as the fourier transform of the odd extension of the modes
+    const std::size_t                 size   = values.size();
+    const std::size_t                 period = 2 * ( size - 1 );
+    std::vector<std::complex<double>> extended( period, 0.0 );
+    for( std::size_t mode = 1; mode + 1 < size; mode++ ) {
+        extended[mode]          = values[mode];
+        extended[period - mode] = -values[mode];
+    }
+    fourierTransform( extended );
+    for( std::size_t m = 0; m < size; m++ ) {
+        values[m] = -0.5 * extended[m].imag();
+    }
+    values[0]        = 0.0;
+    values[size - 1] = 0.0;
+}
+
+void synthesiseSpectrum( const scenario &run, const std::vector<double> &tension, const std::vector<double> &mass, const double deltaLength, std::vector<double> &stringVector, std::vector<double> &velocity ) {
+    // mode m is sin( pi * m * x / length ) like the standing shape, at time 0 of amplitude * cos( omega t + phase ) it adds
+    // amplitude * cos( phase ) to the string and -amplitude * omega * sin( phase ) to the velocity, the largest amplitude is height
+    // omega is the fundamental from the alfven travel time along the line times m, which is close for the low modes
+    const int           numberOfPoints = run.numberOfPoints;
+    const int           modes          = run.modeAmplitudes.empty() ? std::min( run.spectrumModes, numberOfPoints - 2 ) : std::min( static_cast<int>( run.modeAmplitudes.size() ), numberOfPoints - 2 );
+    std::vector<double> amplitudes( modes + 1, 0.0 );
+    std::vector<double> phases( modes + 1, 0.0 );
+    std::mt19937_64     generator( run.spectrumSeed );
+    for( int m = 1; m <= modes; m++ ) {
+        if( run.modeAmplitudes.empty() ) {
+            // the top 53 bits make the phase, so a seed gives the same string on every compiler
+            amplitudes[m] = std::pow( static_cast<double>( m ), -0.5 * run.spectrumSlope );
+            phases[m]     = 2.0 * std::numbers::pi * static_cast<double>( generator() >> 11 ) * 0x1.0p-53;
+        }
+        else {
+            amplitudes[m] = run.modeAmplitudes[m - 1];
+            phases[m]     = m <= static_cast<int>( run.modePhases.size() ) ? run.modePhases[m - 1] : 0.0;
+        }
+    }
+    const double largest = *std::max_element( amplitudes.begin(), amplitudes.end(), []( double a, double b ) { return std::abs( a ) < std::abs( b ); } );
+    const double scale   = largest != 0.0 ? run.height / std::abs( largest ) : 0.0;
+
+    double travelTime = 0.0; // (secconds)
+    for( int i = 0; i < numberOfPoints - 1; i++ ) {
+        travelTime += deltaLength / std::sqrt( 0.5 * ( tension[i] / mass[i] + tension[i + 1] / mass[i + 1] ) );
+    }
+    const double fundamental = std::numbers::pi / travelTime; // (radians/seccond)
+
+    stringVector.assign( numberOfPoints, 0.0 );
+    velocity.assign( numberOfPoints, 0.0 );
+    for( int m = 1; m <= modes; m++ ) {
+        stringVector[m] = scale * amplitudes[m] * std::cos( phases[m] );
+        velocity[m]     = -scale * amplitudes[m] * m * fundamental * std::sin( phases[m] );
+    }
+    sineTransform( stringVector );
+    sineTransform( velocity );
+}
+
+void updateFixedString( std::vector<double> &stringVector, std::vector<double> &velocity, const std::vector<double> &mass, const int numberOfPoints, const std::vector<double> &tension, const double deltaLength, const double deltaTime, stringDiagnostics &diagnostics ) {
     // temporary vectors
     std::vector<double> temporaryString( numberOfPoints, 0.0 );
     temporaryString.at( 0 )                  = stringVector.at( 0 );                  // failsafe lines, however are unused
     temporaryString.at( numberOfPoints - 1 ) = stringVector.at( numberOfPoints - 1 ); // also a failsafe line
+    // diagnostics, the first segment isnt reached by the loop
+    double firstSlope = stringVector.at( 1 ) - stringVector.at( 0 );
+    double kinetic    = 0.0;
+    double potential  = firstSlope * firstSlope;
+    double largest    = 0.0;
     // update the string for non edge points
     for( int i = 1; i < numberOfPoints - 1; i++ ) {
         velocity.at( i ) += ( ( tension.at( i ) / mass.at( i ) ) * ( ( stringVector.at( i - 1 ) - 2 * stringVector.at( i ) + stringVector.at( i + 1 ) ) / pow( deltaLength, 2 ) ) ) * deltaTime;
         temporaryString.at( i ) = stringVector.at( i ) + velocity.at( i ) * deltaTime;
+        // diagnostics, point i and i + 1 havent been overwritten yet
+        double slope = stringVector.at( i + 1 ) - stringVector.at( i );
+        kinetic += mass.at( i ) / tension.at( i ) * velocity.at( i ) * velocity.at( i );
+        potential += slope * slope;
+        largest = std::max( largest, std::abs( temporaryString.at( i ) ) );
         if( i > 2 ) {
             stringVector.at( i - 2 ) = temporaryString.at( i - 2 );
         }
     }
     stringVector.at( numberOfPoints - 2 ) = temporaryString.at( numberOfPoints - 2 ); // last 2 points that dont get changed
     stringVector.at( numberOfPoints - 3 ) = temporaryString.at( numberOfPoints - 3 );
+    diagnostics.kineticEnergy   = 0.5 * kinetic * deltaLength;
+    diagnostics.potentialEnergy = 0.5 * potential / deltaLength;
+    diagnostics.dampingLoss     = 0.0;
+    diagnostics.maxDisplacement = largest;
 }
 
-void updateFreeString( std::vector<double> &stringVector, std::vector<double> &velocity, const std::vector<double> &mass, const int numberOfPoints, const std::vector<double> &tension, const double deltaLength, const double deltaTime ) {
+void updateFreeString( std::vector<double> &stringVector, std::vector<double> &velocity, const std::vector<double> &mass, const int numberOfPoints, const std::vector<double> &tension, const double deltaLength, const double deltaTime, stringDiagnostics &diagnostics ) {
     // temporary vectors
     std::vector<double> temporaryString( numberOfPoints, 0.0 );
     // first and last point
@@ -389,10 +1589,20 @@ void updateFreeString( std::vector<double> &stringVector, std::vector<double> &v
     velocity.at( numberOfPoints - 1 ) += ( -( tension.at( numberOfPoints - 1 ) / mass.at( numberOfPoints - 1 ) ) * ( ( stringVector.at( numberOfPoints - 1 ) - stringVector.at( numberOfPoints - 2 ) ) / pow( deltaLength, 2 ) ) ) * deltaTime;
     temporaryString.at( 0 )                  = stringVector.at( 0 ) + velocity.at( 0 ) * deltaTime;
     temporaryString.at( numberOfPoints - 1 ) = stringVector.at( numberOfPoints - 1 ) + velocity.at( numberOfPoints - 1 ) * deltaTime;
+    // diagnostics, the end points and first segment arent reached by the loop
+    double firstSlope = stringVector.at( 1 ) - stringVector.at( 0 );
+    double kinetic    = mass.at( 0 ) / tension.at( 0 ) * velocity.at( 0 ) * velocity.at( 0 ) + mass.at( numberOfPoints - 1 ) / tension.at( numberOfPoints - 1 ) * velocity.at( numberOfPoints - 1 ) * velocity.at( numberOfPoints - 1 );
+    double potential  = firstSlope * firstSlope;
+    double largest    = std::max( std::abs( temporaryString.at( 0 ) ), std::abs( temporaryString.at( numberOfPoints - 1 ) ) );
     // update the string for non edge points
     for( int i = 1; i < numberOfPoints - 1; i++ ) {
         velocity.at( i ) += ( ( tension.at( i ) / mass.at( i ) ) * ( ( stringVector.at( i - 1 ) - 2 * stringVector.at( i ) + stringVector.at( i + 1 ) ) / pow( deltaLength, 2 ) ) ) * deltaTime;
         temporaryString.at( i ) = stringVector.at( i ) + velocity.at( i ) * deltaTime;
+        // diagnostics, point i and i + 1 havent been overwritten yet
+        double slope = stringVector.at( i + 1 ) - stringVector.at( i );
+        kinetic += mass.at( i ) / tension.at( i ) * velocity.at( i ) * velocity.at( i );
+        potential += slope * slope;
+        largest = std::max( largest, std::abs( temporaryString.at( i ) ) );
         if( i > 2 ) {
             stringVector.at( i - 2 ) = temporaryString.at( i - 2 );
         }
@@ -401,9 +1611,13 @@ void updateFreeString( std::vector<double> &stringVector, std::vector<double> &v
     stringVector.at( numberOfPoints - 3 ) = temporaryString.at( numberOfPoints - 3 );
     stringVector.at( 0 )                  = temporaryString.at( 0 );                  // first point
     stringVector.at( numberOfPoints - 1 ) = temporaryString.at( numberOfPoints - 1 ); // last point
+    diagnostics.kineticEnergy   = 0.5 * kinetic * deltaLength;
+    diagnostics.potentialEnergy = 0.5 * potential / deltaLength;
+    diagnostics.dampingLoss     = 0.0;
+    diagnostics.maxDisplacement = largest;
 }
 
-void updateFreeDispersiveString( std::vector<double> &stringVector, std::vector<double> &velocity, const std::vector<double> &mass, const int numberOfPoints, const std::vector<double> &tension, const double deltaLength, const double deltaTime, const double dampingCoefficient ) {
+void updateFreeDispersiveString( std::vector<double> &stringVector, std::vector<double> &velocity, const std::vector<double> &mass, const int numberOfPoints, const std::vector<double> &tension, const double deltaLength, const double deltaTime, const double dampingCoefficient, stringDiagnostics &diagnostics ) {
     // temporary vectors
     std::vector<double> temporaryString( numberOfPoints, 0.0 );
     // first and last point
@@ -413,10 +1627,20 @@ void updateFreeDispersiveString( std::vector<double> &stringVector, std::vector<
                                          deltaTime;
     temporaryString.at( 0 )                  = stringVector.at( 0 ) + velocity.at( 0 ) * deltaTime;
     temporaryString.at( numberOfPoints - 1 ) = stringVector.at( numberOfPoints - 1 ) + velocity.at( numberOfPoints - 1 ) * deltaTime;
+    // diagnostics, the end points and first segment arent reached by the loop
+    double firstSlope = stringVector.at( 1 ) - stringVector.at( 0 );
+    double kinetic    = mass.at( 0 ) / tension.at( 0 ) * velocity.at( 0 ) * velocity.at( 0 ) + mass.at( numberOfPoints - 1 ) / tension.at( numberOfPoints - 1 ) * velocity.at( numberOfPoints - 1 ) * velocity.at( numberOfPoints - 1 );
+    double potential  = firstSlope * firstSlope;
+    double largest    = std::max( std::abs( temporaryString.at( 0 ) ), std::abs( temporaryString.at( numberOfPoints - 1 ) ) );
     // update the string for non edge points
     for( int i = 1; i < numberOfPoints - 1; i++ ) {
         velocity.at( i ) += ( ( tension.at( i ) / mass.at( i ) ) * ( ( stringVector.at( i - 1 ) - 2 * stringVector.at( i ) + stringVector.at( i + 1 ) ) / pow( deltaLength, 2 ) ) ) * deltaTime;
         temporaryString.at( i ) = stringVector.at( i ) + velocity.at( i ) * deltaTime;
+        // diagnostics, point i and i + 1 havent been overwritten yet
+        double slope = stringVector.at( i + 1 ) - stringVector.at( i );
+        kinetic += mass.at( i ) / tension.at( i ) * velocity.at( i ) * velocity.at( i );
+        potential += slope * slope;
+        largest = std::max( largest, std::abs( temporaryString.at( i ) ) );
         if( i > 2 ) {
             stringVector.at( i - 2 ) = temporaryString.at( i - 2 );
         }
@@ -425,6 +1649,351 @@ void updateFreeDispersiveString( std::vector<double> &stringVector, std::vector<
     stringVector.at( numberOfPoints - 3 ) = temporaryString.at( numberOfPoints - 3 );
     stringVector.at( 0 )                  = temporaryString.at( 0 );                  // first point
     stringVector.at( numberOfPoints - 1 ) = temporaryString.at( numberOfPoints - 1 ); // last point
+    diagnostics.kineticEnergy   = 0.5 * kinetic * deltaLength;
+    diagnostics.potentialEnergy = 0.5 * potential / deltaLength;
+    diagnostics.dampingLoss     = dampingCoefficient * ( mass.at( 0 ) / tension.at( 0 ) * velocity.at( 0 ) * velocity.at( 0 ) + mass.at( numberOfPoints - 1 ) / tension.at( numberOfPoints - 1 ) * velocity.at( numberOfPoints - 1 ) * velocity.at( numberOfPoints - 1 ) ) * deltaTime * deltaLength;
+    diagnostics.maxDisplacement = largest;
+}
+
+void updateString( const stringBoundary boundary, std::vector<double> &stringVector, std::vector<double> &velocity, const std::vector<double> &mass, const int numberOfPoints, const std::vector<double> &tension, const double deltaLength, const double deltaTime, const double dampingCoefficient, stringDiagnostics &diagnostics ) {
+    // picks the update for the run's boundary
+    if( boundary == fixedEnds ) {
+        updateFixedString( stringVector, velocity, mass, numberOfPoints, tension, deltaLength, deltaTime, diagnostics );
+    }
+    else if( boundary == freeEnds ) {
+        updateFreeString( stringVector, velocity, mass, numberOfPoints, tension, deltaLength, deltaTime, diagnostics );
+    }
+    else {
+        updateFreeDispersiveString( stringVector, velocity, mass, numberOfPoints, tension, deltaLength, deltaTime, dampingCoefficient, diagnostics );
+    }
+}
+
+void factoriseCrankNicolson( crankNicolsonOperator &implicitOperator, const stringBoundary boundary, const std::vector<double> &mass, const int numberOfPoints, const std::vector<double> &tension, const double deltaLength, const double deltaTime, const double dampingCoefficient ) {
+    // crank nicolson on dy/dt = v, dv/dt = L y - D v, with v( n + 1 ) eliminated this leaves
+    // ( I + dt / 2 D - dt^2 / 4 L ) dy = dt v + dt^2 / 2 L y, a tridiagonal system that only depends on the string and dt
+    // so the thomas forward sweep is done once here, the matrix is diagonally dominant so no pivoting is needed
+    const double quarter = deltaTime * deltaTime / 4.0;
+    const double damping = boundary == dampedEnds ? dampingCoefficient * deltaTime / 2.0 : 0.0;
+    const int    last    = numberOfPoints - 1;
+    implicitOperator.boundary  = boundary;
+    implicitOperator.deltaTime = deltaTime;
+    implicitOperator.damping   = boundary == dampedEnds ? dampingCoefficient : 0.0;
+    implicitOperator.coefficient.assign( numberOfPoints, 0.0 );
+    implicitOperator.lower.assign( numberOfPoints, 0.0 );
+    implicitOperator.upper.assign( numberOfPoints, 0.0 );
+    implicitOperator.inverseDiagonal.assign( numberOfPoints, 0.0 );
+    implicitOperator.rightHandSide.assign( numberOfPoints, 0.0 );
+    implicitOperator.endChange[0] = 0.0;
+    implicitOperator.endChange[1] = 0.0;
+    for( int i = 0; i < numberOfPoints; i++ ) {
+        implicitOperator.coefficient[i] = tension[i] / ( mass[i] * deltaLength * deltaLength );
+    }
+    // rows of the matrix, fixed ends never move so their rows are the identity
+    std::vector<double> diagonal( numberOfPoints, 1.0 );
+    std::vector<double> upper( numberOfPoints, 0.0 );
+    for( int i = 1; i < last; i++ ) {
+        implicitOperator.lower[i] = -quarter * implicitOperator.coefficient[i];
+        diagonal[i]               = 1.0 + 2.0 * quarter * implicitOperator.coefficient[i];
+        upper[i]                  = -quarter * implicitOperator.coefficient[i];
+    }
+    if( boundary != fixedEnds ) {
+        diagonal[0]                  = 1.0 + damping + quarter * implicitOperator.coefficient[0];
+        upper[0]                     = -quarter * implicitOperator.coefficient[0];
+        implicitOperator.lower[last] = -quarter * implicitOperator.coefficient[last];
+        diagonal[last]               = 1.0 + damping + quarter * implicitOperator.coefficient[last];
+    }
+    // forward sweep, keeps the eliminated upper diagonal and one over each pivot
+    implicitOperator.inverseDiagonal[0] = 1.0 / diagonal[0];
+    implicitOperator.upper[0]           = upper[0] * implicitOperator.inverseDiagonal[0];
+    for( int i = 1; i < numberOfPoints; i++ ) {
+        implicitOperator.inverseDiagonal[i] = 1.0 / ( diagonal[i] - implicitOperator.lower[i] * implicitOperator.upper[i - 1] );
+        implicitOperator.upper[i]           = upper[i] * implicitOperator.inverseDiagonal[i];
+    }
+}
+
+void updateCrankNicolsonString( crankNicolsonOperator &implicitOperator, std::vector<double> &stringVector, std::vector<double> &velocity, const std::vector<double> &mass, const int numberOfPoints, const std::vector<double> &tension, const double deltaLength, stringDiagnostics &diagnostics ) {
+    // one step with the cached factorisation, stable for any time step so dt only needs to resolve the frequencies of interest
+    const double  deltaTime = implicitOperator.deltaTime;
+    const double  half      = deltaTime * deltaTime / 2.0;
+    const int     last      = numberOfPoints - 1;
+    const double *k         = implicitOperator.coefficient.data();
+    const double *a         = implicitOperator.lower.data();
+    const double *c         = implicitOperator.upper.data();
+    const double *w         = implicitOperator.inverseDiagonal.data();
+    double       *d         = implicitOperator.rightHandSide.data();
+    double       *y         = stringVector.data();
+    double       *v         = velocity.data();
+    // right hand side and forward substitution in one pass
+    for( int i = 0; i < numberOfPoints; i++ ) {
+        double rightHandSide = 0.0;
+        if( i == 0 || i == last ) {
+            if( implicitOperator.boundary != fixedEnds ) {
+                const double neighbour = i == 0 ? y[1] : y[last - 1];
+                rightHandSide          = deltaTime * v[i] + half * k[i] * ( neighbour - y[i] );
+            }
+            else {
+                // fixed rows are the identity so a driven end's move is carried into its neighbours by the sweep
+                rightHandSide = implicitOperator.endChange[i == last];
+            }
+        }
+        else {
+            rightHandSide = deltaTime * v[i] + half * k[i] * ( y[i - 1] - 2.0 * y[i] + y[i + 1] );
+        }
+        d[i] = ( rightHandSide - ( i > 0 ? a[i] * d[i - 1] : 0.0 ) ) * w[i];
+    }
+    // back substitution gives the change in y, v( n + 1 ) = 2 dy / dt - v( n )
+    double kinetic = 0.0;
+    double loss    = 0.0;
+    double largest = 0.0;
+    for( int i = last; i >= 0; i-- ) {
+        if( i < last ) {
+            d[i] -= c[i] * d[i + 1];
+        }
+        const double newVelocity = 2.0 * d[i] / deltaTime - v[i];
+        if( ( i == 0 || i == last ) && implicitOperator.damping != 0.0 ) {
+            // the damping force acts on the mean velocity over the step
+            const double meanVelocity = 0.5 * ( newVelocity + v[i] );
+            loss += implicitOperator.damping * mass[i] / tension[i] * meanVelocity * meanVelocity * deltaTime * deltaLength;
+        }
+        y[i] += d[i];
+        v[i] = newVelocity;
+        kinetic += mass[i] / tension[i] * newVelocity * newVelocity;
+        largest = std::max( largest, std::abs( y[i] ) );
+    }
+    // potential energy of the new string
+    double potential = 0.0;
+    for( int i = 0; i < last; i++ ) {
+        const double slope = y[i + 1] - y[i];
+        potential += slope * slope;
+    }
+    diagnostics.kineticEnergy   = 0.5 * kinetic * deltaLength;
+    diagnostics.potentialEnergy = 0.5 * potential / deltaLength;
+    diagnostics.dampingLoss     = loss;
+    diagnostics.maxDisplacement = largest;
+}
+
+bool isUnstable( const stringDiagnostics &diagnostics, const long long steps, double &initialEnergy ) {
+    // energy can only fall with damping so a large rise means the run has blown up
+    double energy = diagnostics.kineticEnergy + diagnostics.potentialEnergy;
+    if( steps == 1 ) {
+        initialEnergy = energy;
+    }
+    return !std::isfinite( energy ) || !std::isfinite( diagnostics.maxDisplacement ) || ( initialEnergy > 0.0 && energy > energyGrowthLimit * initialEnergy );
+}
+
+template <precisionMode mode>
+workType<mode> updateMixedEnd( storageType<mode> *y, storageType<mode> *v, const storageType<mode> *k, const storageType<mode> *w, const int end, const int inside, const workType<mode> dt, const workType<mode> damping, const double deltaTime, double &kinetic, double &loss ) {
+    // free or damped end, the velocity is stored and the new end value returned so the interior still sees the old one
+    typedef storageType<mode> real;
+    typedef workType<mode>    work;
+    const work vEnd = v[end] + ( k[end] * ( work( y[inside] ) - y[end] ) - damping * v[end] ) * dt;
+    kinetic += static_cast<double>( w[end] ) * vEnd * vEnd;
+    loss += damping * static_cast<double>( w[end] ) * vEnd * vEnd * deltaTime;
+    v[end] = static_cast<real>( vEnd );
+    return y[end] + vEnd * dt;
+}
+
+template <precisionMode mode>
+inline void updateMixedPoint( storageType<mode> *__restrict y, storageType<mode> *__restrict v, storageType<mode> *__restrict c, const storageType<mode> *__restrict k, const storageType<mode> *__restrict w, const int i, const workType<mode> previous, const workType<mode> current, const workType<mode> next, const workType<mode> dt, double &kinetic, double &potential, double &largest ) {
+    // one interior point from the old values of it and its neighbours, the caller has read them before any were overwritten
+    typedef storageType<mode> real;
+    typedef workType<mode>    work;
+    const work   vi    = v[i] + k[i] * ( previous - 2 * current + next ) * dt;
+    const double slope = static_cast<double>( next ) - current;
+    kinetic += static_cast<double>( w[i] ) * vi * vi;
+    potential += static_cast<double>( k[i] ) * w[i] * slope * slope;
+    if constexpr( mode == floatKahanAccumulation ) {
+        // the step is tiny next to y, the compensation carries the bits float drops
+        const work increment = vi * dt - c[i];
+        const work sum       = current + increment;
+        c[i]                 = ( sum - current ) - increment;
+        y[i]                 = sum;
+    }
+    else {
+        y[i] = static_cast<real>( current + vi * dt );
+    }
+    v[i]    = static_cast<real>( vi );
+    largest = std::max( largest, std::abs( static_cast<double>( y[i] ) ) );
+}
+
+template <precisionMode mode>
+void updateMixedInterior( storageType<mode> *y, storageType<mode> *v, storageType<mode> *c, const storageType<mode> *k, const storageType<mode> *w, const workType<mode> dt, const int first, const int end, double &kinetic, double &potential, double &largest ) {
+    // points first to end - 1 in place, point first - 1 must not have been updated yet this step
+    typedef workType<mode> work;
+    const double firstSlope = static_cast<double>( y[first] ) - y[first - 1];
+    potential += static_cast<double>( k[first - 1] ) * w[first - 1] * firstSlope * firstSlope;
+    // a single running sum is a chain of dependent adds the compiler wont reorder, so each lane keeps its own
+    double laneKinetic[mixedLanes]   = {};
+    double lanePotential[mixedLanes] = {};
+    double laneLargest[mixedLanes]   = {};
+    // previous holds the old value of the point before i as it has already been overwritten,
+    // whole blocks read their old values before writing any so every lane in a block is independent
+    work previous = y[first - 1];
+    int  i        = first;
+    for( ; i + mixedLanes <= end; i += mixedLanes ) {
+        work old[mixedLanes + 2];
+        old[0] = previous;
+#pragma GCC unroll 17
+        for( int lane = 0; lane <= mixedLanes; lane++ ) {
+            old[lane + 1] = y[i + lane];
+        }
+#pragma GCC unroll 16
+        for( int lane = 0; lane < mixedLanes; lane++ ) {
+            updateMixedPoint<mode>( y, v, c, k, w, i + lane, old[lane], old[lane + 1], old[lane + 2], dt, laneKinetic[lane], lanePotential[lane], laneLargest[lane] );
+        }
+        previous = old[mixedLanes];
+    }
+    for( ; i < end; i++ ) {
+        const work current = y[i];
+        updateMixedPoint<mode>( y, v, c, k, w, i, previous, current, y[i + 1], dt, laneKinetic[0], lanePotential[0], laneLargest[0] );
+        previous = current;
+    }
+    for( int lane = 0; lane < mixedLanes; lane++ ) {
+        kinetic += laneKinetic[lane];
+        potential += lanePotential[lane];
+        largest = std::max( largest, laneLargest[lane] );
+    }
+}
+
+template <precisionMode mode>
+void updateMixedString( const stringBoundary boundary, std::vector<storageType<mode>> &stringVector, std::vector<storageType<mode>> &velocity, std::vector<storageType<mode>> &compensation, const std::vector<storageType<mode>> &coefficient, const std::vector<storageType<mode>> &weight, const int numberOfPoints, const double deltaTime, const double dampingCoefficient, stringDiagnostics &diagnostics ) {
+    // the same scheme as the double kernels done in place, coefficient is tension / ( mass * deltaLength^2 )
+    // and weight is mass * deltaLength / tension, so the kinetic sum is weight * v^2 and the potential sum coefficient * weight * dy^2
+    // arithmetic is done in workType, the diagnostics sums are always double
+    typedef storageType<mode> real;
+    typedef workType<mode>    work;
+    real      *y         = stringVector.data();
+    const work dt        = static_cast<work>( deltaTime );
+    const int  last      = numberOfPoints - 1;
+    double     kinetic   = 0.0;
+    double     loss      = 0.0;
+    double     largest   = 0.0;
+    double     potential = 0.0;
+    // end points are worked out from the old string before the interior overwrites it
+    work firstY = y[0];
+    work lastY  = y[last];
+    if( boundary != fixedEnds ) {
+        const work damping = boundary == dampedEnds ? static_cast<work>( dampingCoefficient ) : work( 0 );
+        firstY             = updateMixedEnd<mode>( y, velocity.data(), coefficient.data(), weight.data(), 0, 1, dt, damping, deltaTime, kinetic, loss );
+        lastY              = updateMixedEnd<mode>( y, velocity.data(), coefficient.data(), weight.data(), last, last - 1, dt, damping, deltaTime, kinetic, loss );
+    }
+    updateMixedInterior<mode>( y, velocity.data(), compensation.data(), coefficient.data(), weight.data(), dt, 1, last, kinetic, potential, largest );
+    y[0]                        = static_cast<real>( firstY );
+    y[last]                     = static_cast<real>( lastY );
+    largest                     = std::max( { largest, std::abs( static_cast<double>( y[0] ) ), std::abs( static_cast<double>( y[last] ) ) } );
+    diagnostics.kineticEnergy   = 0.5 * kinetic;
+    diagnostics.potentialEnergy = 0.5 * potential;
+    diagnostics.dampingLoss     = loss;
+    diagnostics.maxDisplacement = largest;
+}
+
+template <precisionMode mode>
+void initialiseActivityMask( activityMask &mask, const std::vector<storageType<mode>> &stringVector, const std::vector<storageType<mode>> &velocity, const std::vector<storageType<mode>> &coefficient, const int numberOfPoints, const double deltaTime ) {
+    // an explicit step moves a disturbance at most one point, or the wave speed times dt if that is further
+    double fastest = 0.0;
+    double largest = 0.0;
+    for( int i = 0; i < numberOfPoints; i++ ) {
+        fastest = std::max( fastest, std::sqrt( static_cast<double>( coefficient[i] ) ) * deltaTime );
+        largest = std::max( largest, std::abs( static_cast<double>( stringVector[i] ) ) );
+    }
+    const int marginPoints = std::max( 1, static_cast<int>( std::ceil( fastest ) ) );
+    mask.blocks            = ( numberOfPoints + activityBlockPoints - 1 ) / activityBlockPoints;
+    mask.margin            = ( marginPoints + activityBlockPoints - 1 ) / activityBlockPoints;
+    mask.threshold         = activityThreshold * largest;
+    mask.fullSweep         = false;
+    mask.pointUpdates      = 0;
+    mask.active.assign( mask.blocks, 0 );
+    mask.busy.assign( mask.blocks, 0 );
+    for( int i = 0; i < numberOfPoints; i++ ) {
+        if( std::abs( static_cast<double>( stringVector[i] ) ) > mask.threshold || std::abs( static_cast<double>( velocity[i] ) ) * deltaTime > mask.threshold ) {
+            mask.busy[i / activityBlockPoints] = 1;
+        }
+    }
+    widenActivityMask( mask );
+}
+
+void widenActivityMask( activityMask &mask ) {
+    // next step's blocks are the busy ones and everything within the margin of them, too many and the mask is dropped
+    std::fill( mask.active.begin(), mask.active.end(), 0 );
+    int count = 0;
+    for( int block = 0; block < mask.blocks; block++ ) {
+        if( mask.busy[block] ) {
+            const int end = std::min( block + mask.margin, mask.blocks - 1 );
+            for( int neighbour = std::max( block - mask.margin, 0 ); neighbour <= end; neighbour++ ) {
+                count += !mask.active[neighbour];
+                mask.active[neighbour] = 1;
+            }
+        }
+    }
+    mask.fullSweep = count > activityFullSweepFraction * mask.blocks;
+}
+
+template <precisionMode mode>
+void updateActiveString( activityMask &mask, const stringBoundary boundary, std::vector<storageType<mode>> &stringVector, std::vector<storageType<mode>> &velocity, std::vector<storageType<mode>> &compensation, const std::vector<storageType<mode>> &coefficient, const std::vector<storageType<mode>> &weight, const int numberOfPoints, const double deltaTime, const double dampingCoefficient, stringDiagnostics &diagnostics ) {
+    // updateMixedString on runs of active blocks only, quiet blocks are below the threshold so leaving them out
+    // changes the string and the diagnostics by no more than that
+    if( mask.fullSweep ) {
+        updateMixedString<mode>( boundary, stringVector, velocity, compensation, coefficient, weight, numberOfPoints, deltaTime, dampingCoefficient, diagnostics );
+        mask.pointUpdates += numberOfPoints;
+        return;
+    }
+    typedef storageType<mode> real;
+    typedef workType<mode>    work;
+    real      *y          = stringVector.data();
+    real      *v          = velocity.data();
+    const work dt         = static_cast<work>( deltaTime );
+    const int  last       = numberOfPoints - 1;
+    const bool firstEnd   = boundary != fixedEnds && mask.active[0];
+    const bool lastEnd    = boundary != fixedEnds && mask.active[mask.blocks - 1];
+    const work damping    = boundary == dampedEnds ? static_cast<work>( dampingCoefficient ) : work( 0 );
+    double     kinetic    = 0.0;
+    double     loss       = 0.0;
+    double     largest    = 0.0;
+    double     potential  = 0.0;
+    work       firstY     = y[0];
+    work       lastY      = y[last];
+    if( firstEnd ) {
+        firstY = updateMixedEnd<mode>( y, v, coefficient.data(), weight.data(), 0, 1, dt, damping, deltaTime, kinetic, loss );
+    }
+    if( lastEnd ) {
+        lastY = updateMixedEnd<mode>( y, v, coefficient.data(), weight.data(), last, last - 1, dt, damping, deltaTime, kinetic, loss );
+    }
+    for( int block = 0; block < mask.blocks; block++ ) {
+        if( !mask.active[block] ) {
+            continue;
+        }
+        // the run of active blocks starting here, the point before it is quiet so it hasnt been overwritten
+        int endBlock = block;
+        while( endBlock < mask.blocks && mask.active[endBlock] ) {
+            endBlock += 1;
+        }
+        const int first = std::max( block * activityBlockPoints, 1 );
+        const int end   = std::min( endBlock * activityBlockPoints, last );
+        updateMixedInterior<mode>( y, v, compensation.data(), coefficient.data(), weight.data(), dt, first, end, kinetic, potential, largest );
+        mask.pointUpdates += end - first;
+        block = endBlock;
+    }
+    y[0]    = static_cast<real>( firstY );
+    y[last] = static_cast<real>( lastY );
+    largest = std::max( { largest, std::abs( static_cast<double>( y[0] ) ), std::abs( static_cast<double>( y[last] ) ) } );
+
+    // blocks that were updated are checked against the threshold, the rest were quiet and havent changed
+    const double threshold = mask.threshold;
+    for( int block = 0; block < mask.blocks; block++ ) {
+        if( mask.active[block] ) {
+            const int end    = std::min( ( block + 1 ) * activityBlockPoints, numberOfPoints );
+            bool      moving = false;
+            for( int i = block * activityBlockPoints; i < end; i++ ) {
+                moving = moving || std::abs( static_cast<double>( y[i] ) ) > threshold || std::abs( static_cast<double>( v[i] ) ) * deltaTime > threshold;
+            }
+            mask.busy[block] = moving;
+        }
+    }
+    widenActivityMask( mask );
+    diagnostics.kineticEnergy   = 0.5 * kinetic;
+    diagnostics.potentialEnergy = 0.5 * potential;
+    diagnostics.dampingLoss     = loss;
+    diagnostics.maxDisplacement = largest;
 }
 
 // magnetic dipole functions
@@ -518,90 +2087,1758 @@ double lengthOfMagneticFieldLine( const double latitude, const int numberOfPoint
         length += std::sqrt( xStep * xStep + yStep * yStep + zStep * zStep );
         points.push_back( { x, y, z } );
 
-        double radius = std::sqrt( x * x + y * y + z * z );
+        double radius = std::sqrt( x * x + y * y + z * z );
+
+        if( radius <= radiusEarth ) {
+            break;
+        }
+    }
+
+    for( int i = 0; i < numberOfPoints; ++i ) {
+        int index = i * ( points.size() - 1 ) / ( numberOfPoints - 1 );
+        worldPoints.push_back( points[index] );
+    }
+
+    return length;
+}
+
+// miscellaneous functions
+// -----------------------
+
+void makeAxisTicks( point *axisTicks, int numberOfTicks, float tickSize, GLFWwindow *window ) {
+    // window width and height
+    int width;
+    int height;
+    glfwGetFramebufferSize( window, &width, &height );
+    // aspect ratio for equivilent sized ticks
+    float aspectRatio = static_cast<float>( width ) / static_cast<float>( height );
+    int   i           = 0;
+    for( int j = -numberOfTicks; j <= numberOfTicks; ++j ) {
+        float tick = static_cast<float>( j ) / numberOfTicks;
+
+        // x axis
+        axisTicks[i++] = { tick, tickSize * aspectRatio };
+        axisTicks[i++] = { tick, -tickSize * aspectRatio };
+        // y axis
+        axisTicks[i++] = { -tickSize, tick };
+        axisTicks[i++] = { tickSize, tick };
+    }
+}
+
+void pushToBuffer( std::queue<bufferData> &buffer, const std::vector<double> &stringVector, const double time ) {
+    TRACE_ZONE( "pushToBuffer" );
+    // buffers the past 10 values passed into it
+    bufferData data;
+    data.string = stringVector;
+    data.time   = time;
+    buffer.push( data );
+    if( buffer.size() > 10 ) {
+        buffer.pop();
+    }
+}
+
+void writeToFile( std::queue<bufferData> buffer, std::ofstream &data, const double deltaLength ) {
+    TRACE_ZONE( "writeToFile" );
+    // saves the buffered data to the file
+    const int initialBufferSize = buffer.size();
+    for( int i = 0; i < initialBufferSize; i++ ) {
+        std::vector<double> stringVector = buffer.front().string;
+        double              time         = buffer.front().time;
+        for( int j = 0; j < stringVector.size(); j++ ) {
+            data << std::format( "{:.1f}\t{}\t{}\n", time, j * deltaLength, stringVector.at( j ) );
+        }
+        buffer.pop();
+    }
+    std::cout << "Data Saved!" << std::endl;
+}
+
+void initialiseTripleBuffer( tripleBuffer &frames, const std::vector<double> &stringVector, const double time ) {
+    // every slot starts as the initial string so the reader always has something valid to draw
+    for( int i = 0; i < 3; i++ ) {
+        frames.slots[i].string = stringVector;
+        frames.slots[i].time   = time;
+    }
+    frames.writeSlot = 0;
+    frames.middle    = 1;
+    frames.readSlot  = 2;
+}
+
+void publishFrame( tripleBuffer &frames ) {
+    // swaps the written slot into the middle and takes back whichever slot was there
+    frames.writeSlot = frames.middle.exchange( frames.writeSlot | newFrameBit, std::memory_order_acq_rel ) & ~newFrameBit;
+}
+
+bool acquireFrame( tripleBuffer &frames ) {
+    // only swaps if the solver has published since the last read
+    if( !( frames.middle.load( std::memory_order_acquire ) & newFrameBit ) ) {
+        return false;
+    }
+    frames.readSlot = frames.middle.exchange( frames.readSlot, std::memory_order_acq_rel ) & ~newFrameBit;
+    return true;
+}
+
+void solveString( solverShared &shared, std::vector<double> &stringVector, std::vector<double> &velocity, const std::vector<double> &mass, const std::vector<double> &tension, const int numberOfPoints, const double deltaLength, const double deltaTime, const stringBoundary boundary, const stringScheme scheme, const double dampingCoefficient, double autoSaveTime, std::queue<bufferData> &buffer, std::ofstream &data, std::ofstream &diagnosticsData ) {
+    double    time        = 0.0; // time (secconds)
+    int       intTime     = 0;   // integer time used for buffering data
+    long long steps       = 0;   // steps taken, only shared when a frame is published
+    auto      publishTime = std::chrono::steady_clock::now();
+    // diagnostics
+    stringDiagnostics diagnostics;
+    double            dampingLoss   = 0.0; // energy lost at the ends since the start
+    double            initialEnergy = 0.0; // energy after the first step
+    // implicit steps factorise the string once up front
+    crankNicolsonOperator implicitOperator;
+    if( scheme == crankNicolsonScheme ) {
+        factoriseCrankNicolson( implicitOperator, boundary, mass, numberOfPoints, tension, deltaLength, deltaTime, dampingCoefficient );
+    }
+    TRACE_THREAD( "solver" );
+    while( shared.running.load( std::memory_order_relaxed ) ) {
+        // caught up, hands over the string and waits for the render thread to move the target on
+        if( time > shared.targetTime.load( std::memory_order_relaxed ) + 1e-4 ) {
+            std::this_thread::sleep_for( std::chrono::microseconds( 200 ) );
+            continue;
+        }
+
+        // auto save
+        if( autoSaveTime != 0.0 && time + 1e-4 > autoSaveTime ) {
+            shared.saveRequested = true;
+            autoSaveTime         = 0.0;
+        }
+
+        // saving and buffering data
+        if( shared.saveRequested.exchange( false ) ) {
+            writeToFile( buffer, data, deltaLength );
+        }
+        else if( time + 1e-4 >= intTime ) { // push to buffer every int seccond
+            // buffer data
+            pushToBuffer( buffer, stringVector, time );
+            shared.counters.bufferedFrames.store( buffer.size(), std::memory_order_relaxed );
+            std::cout << std::format( "Time: {:.1f}s, {:.1f}m", time, time / 60.0 ) << std::endl;
+            intTime += 1;
+        }
+        if( shared.history.descriptor >= 0 && !shared.history.failed && time + 1e-4 >= shared.history.queued * historyInterval ) {
+            queueHistory( shared.history, stringVector, time );
+        }
+
+        // updates string
+        {
+            TRACE_ZONE( "string update" );
+            if( scheme == crankNicolsonScheme ) {
+                updateCrankNicolsonString( implicitOperator, stringVector, velocity, mass, numberOfPoints, tension, deltaLength, diagnostics );
+            }
+            else {
+                updateString( boundary, stringVector, velocity, mass, numberOfPoints, tension, deltaLength, deltaTime, dampingCoefficient, diagnostics );
+            }
+        }
+        time += deltaTime;
+        steps += 1;
+
+        // diagnostics, stops the run rather than animate one that has blown up
+        dampingLoss += diagnostics.dampingLoss;
+        writeDiagnostics( diagnosticsData, diagnostics, time, dampingLoss );
+        if( isUnstable( diagnostics, steps, initialEnergy ) ) {
+            std::cerr << std::format( "Error: unstable at {:.4f}s, energy {:.3e} from {:.3e}, max |y| {:.3e}, check the time step against the wave speed\n\n", time, diagnostics.kineticEnergy + diagnostics.potentialEnergy, initialEnergy, diagnostics.maxDisplacement );
+            shared.unstable = true;
+            break;
+        }
+
+        // publishes when caught up, or every few milliseconds while catching up so the copy isnt done every step
+        auto now = std::chrono::steady_clock::now();
+        if( time > shared.targetTime.load( std::memory_order_relaxed ) + 1e-4 || now - publishTime > std::chrono::milliseconds( 4 ) ) {
+            TRACE_ZONE( "publish" );
+            bufferData &frame = shared.frames.slots[shared.frames.writeSlot];
+            std::copy( stringVector.begin(), stringVector.end(), frame.string.begin() );
+            frame.time = time;
+            publishFrame( shared.frames );
+            publishTime = now;
+            shared.counters.steps.store( steps, std::memory_order_relaxed );
+            shared.counters.solvedTime.store( time, std::memory_order_relaxed );
+        }
+    }
+}
+
+void writeDiagnostics( std::ofstream &diagnosticsData, const stringDiagnostics &diagnostics, const double time, const double dampingLoss ) {
+    // one record per step of float32 time, kinetic energy, potential energy, total damping loss and max |y|
+    const float record[5] = { static_cast<float>( time ), static_cast<float>( diagnostics.kineticEnergy ), static_cast<float>( diagnostics.potentialEnergy ), static_cast<float>( dampingLoss ), static_cast<float>( diagnostics.maxDisplacement ) };
+    diagnosticsData.write( reinterpret_cast<const char *>( record ), sizeof( record ) );
+}
+
+std::string checkWaveSpeed( const std::vector<double> &tension, const std::vector<double> &mass, const double deltaTime, const double length, const int numberOfPoints ) {
+    // returns the warning rather than printing it, jobs check from several threads at once
+    double Va    = 0.0; // Alfven velocity
+    double VaMax = 0.0;
+    for( int i = 0; i < numberOfPoints; ++i ) {
+        if( mass[i] <= 0.0 ) {
+            return "Invalid mass";
+        }
+        Va = std::sqrt( tension[i] / mass[i] );
+        if( Va > VaMax ) {
+            VaMax = Va;
+        }
+    }
+    if( VaMax > ( ( length / ( numberOfPoints - 1 ) ) / deltaTime ) ) {
+        return std::format( "Delta time is too large, it needs to be under {:.3e}s, deltaTime = auto picks one", ( length / ( numberOfPoints - 1 ) ) / VaMax );
+    }
+    return "";
+}
+
+// scenario functions
+// ------------------
+
+scenario defaultScenario() {
+    // the run the model used to be hard coded to
+    scenario run;
+    run.name               = "default";
+    run.latitudeDegrees    = 70.0;
+    run.numberOfPoints     = 1001;
+    run.shape              = "plucked";
+    run.height             = 100000.0;
+    run.pulseWidth         = 5e6;
+    run.pulseStart         = 5e7;
+    run.mode               = 3;
+    run.boundary           = dampedEnds;
+    run.scheme             = explicitScheme;
+    run.deltaTime          = 0.001;
+    run.autoDeltaTime      = false;
+    run.kernel             = referenceKernel;
+    run.dampingCoefficient = 1.0;
+    run.autoSaveTime       = 0.0;
+    run.endTime            = 60.0;
+    run.snapshotInterval   = 1.0;
+    run.outputDirectory    = "../../data";
+    run.precision          = doublePrecision;
+    run.audioSpeedUp       = 20000.0;
+    run.audioSampleRate    = 48000;
+    run.audioFormat        = "pcm16";
+    run.audioGain          = 0.5;
+    run.sparseUpdates      = false;
+    run.spectrumModes      = 256;
+    run.spectrumSlope      = 2.0;
+    run.spectrumSeed       = 1;
+    run.driveFirst         = true;
+    run.driveLast          = false;
+    run.driveInterval      = 1.0;
+    run.driveGain          = 1.0;
+    run.driveInterpolation = "cubic";
+    run.probeInterpolation = "linear";
+    run.probeEvery         = 1;
+    run.fieldLines         = 64;
+    run.historyFrames      = 12000;
+    run.displacedLines     = 1;
+    run.offscreen          = false;
+    run.frameInterval      = 1.0 / 30.0;
+    run.offscreenLength    = 60.0;
+    return run;
+}
+
+std::string trim( const std::string &text ) {
+    std::size_t first = text.find_first_not_of( " \t\r" );
+    if( first == std::string::npos ) {
+        return "";
+    }
+    return text.substr( first, text.find_last_not_of( " \t\r" ) - first + 1 );
+}
+
+std::vector<double> parseList( const std::string &value ) {
+    // comma separated numbers, an empty value is an empty list
+    std::vector<double> list;
+    std::size_t         start = 0;
+    while( start < value.size() ) {
+        std::size_t end = value.find( ',', start );
+        if( end == std::string::npos ) {
+            end = value.size();
+        }
+        list.push_back( std::stod( value.substr( start, end - start ) ) );
+        start = end + 1;
+    }
+    return list;
+}
+
+void setScenarioValue( scenario &run, const std::string &key, const std::string &value ) {
+    // throws on an unknown key or a value that doesnt parse, loadScenarios reports where
+    if( key == "latitude" ) {
+        run.latitudeDegrees = std::stod( value );
+    }
+    else if( key == "numberOfPoints" ) {
+        run.numberOfPoints = std::stoi( value );
+        if( run.numberOfPoints < 5 || run.numberOfPoints % 2 == 0 ) {
+            throw std::invalid_argument( "numberOfPoints must be odd and at least 5" );
+        }
+    }
+    else if( key == "shape" ) {
+        if( value != "flat" && value != "plucked" && value != "pulse" && value != "standing" && value != "spectrum" ) {
+            throw std::invalid_argument( "shape must be flat, plucked, pulse, standing or spectrum" );
+        }
+        run.shape = value;
+    }
+    else if( key == "height" ) {
+        run.height = std::stod( value );
+    }
+    else if( key == "pulseWidth" ) {
+        run.pulseWidth = std::stod( value );
+    }
+    else if( key == "pulseStart" ) {
+        run.pulseStart = std::stod( value );
+    }
+    else if( key == "mode" ) {
+        run.mode = std::stoi( value );
+    }
+    else if( key == "boundary" ) {
+        if( value == "fixed" ) {
+            run.boundary = fixedEnds;
+        }
+        else if( value == "free" ) {
+            run.boundary = freeEnds;
+        }
+        else if( value == "damped" ) {
+            run.boundary = dampedEnds;
+        }
+        else {
+            throw std::invalid_argument( "boundary must be fixed, free or damped" );
+        }
+    }
+    else if( key == "scheme" ) {
+        if( value == "explicit" ) {
+            run.scheme = explicitScheme;
+        }
+        else if( value == "crankNicolson" ) {
+            run.scheme = crankNicolsonScheme;
+            if( run.autoDeltaTime ) {
+                throw std::invalid_argument( "deltaTime = auto is the explicit stability limit, crank nicolson needs a deltaTime set for accuracy" );
+            }
+        }
+        else {
+            throw std::invalid_argument( "scheme must be explicit or crankNicolson" );
+        }
+    }
+    else if( key == "deltaTime" ) {
+        run.autoDeltaTime = value == "auto";
+        if( run.autoDeltaTime && run.scheme == crankNicolsonScheme ) {
+            throw std::invalid_argument( "auto is the explicit stability limit, crank nicolson needs a deltaTime set for accuracy" );
+        }
+        if( !run.autoDeltaTime ) {
+            run.deltaTime = std::stod( value );
+            if( run.deltaTime <= 0.0 ) {
+                throw std::invalid_argument( "deltaTime must be above 0 or auto" );
+            }
+        }
+    }
+    else if( key == "kernel" ) {
+        if( value == "reference" ) {
+            run.kernel = referenceKernel;
+        }
+        else if( value == "inPlace" ) {
+            run.kernel = inPlaceKernel;
+        }
+        else if( value == "auto" ) {
+            run.kernel = autoKernel;
+        }
+        else {
+            throw std::invalid_argument( "kernel must be reference, inPlace or auto" );
+        }
+    }
+    else if( key == "dampingCoefficient" ) {
+        run.dampingCoefficient = std::stod( value );
+    }
+    else if( key == "autoSaveTime" ) {
+        run.autoSaveTime = std::stod( value );
+    }
+    else if( key == "endTime" ) {
+        run.endTime = std::stod( value );
+        if( run.endTime <= 0.0 ) {
+            throw std::invalid_argument( "endTime must be above 0" );
+        }
+    }
+    else if( key == "snapshotInterval" ) {
+        run.snapshotInterval = std::stod( value );
+        if( run.snapshotInterval <= 0.0 ) {
+            throw std::invalid_argument( "snapshotInterval must be above 0" );
+        }
+    }
+    else if( key == "outputDirectory" ) {
+        run.outputDirectory = value;
+    }
+    else if( key == "precision" ) {
+        if( value == "double" ) {
+            run.precision = doublePrecision;
+        }
+        else if( value == "float" ) {
+            run.precision = floatPrecision;
+        }
+        else if( value == "floatDouble" ) {
+            run.precision = floatDoubleAccumulation;
+        }
+        else if( value == "floatKahan" ) {
+            run.precision = floatKahanAccumulation;
+        }
+        else {
+            throw std::invalid_argument( "precision must be double, float, floatDouble or floatKahan" );
+        }
+    }
+    else if( key == "pickups" ) {
+        // an empty value turns the audio off
+        run.pickups = parseList( value );
+        for( double pickup : run.pickups ) {
+            if( pickup < 0.0 || pickup > 1.0 ) {
+                throw std::invalid_argument( "pickups must be between 0 and 1" );
+            }
+        }
+    }
+    else if( key == "audioSpeedUp" ) {
+        run.audioSpeedUp = std::stod( value );
+    }
+    else if( key == "audioSampleRate" ) {
+        run.audioSampleRate = std::stoi( value );
+    }
+    else if( key == "audioFormat" ) {
+        if( value != "pcm16" && value != "pcm24" && value != "float" ) {
+            throw std::invalid_argument( "audioFormat must be pcm16, pcm24 or float" );
+        }
+        run.audioFormat = value;
+    }
+    else if( key == "audioGain" ) {
+        run.audioGain = std::stod( value );
+    }
+    else if( key == "spectrumModes" ) {
+        run.spectrumModes = std::stoi( value );
+        if( run.spectrumModes < 1 ) {
+            throw std::invalid_argument( "spectrumModes must be at least 1" );
+        }
+    }
+    else if( key == "spectrumSlope" ) {
+        run.spectrumSlope = std::stod( value );
+    }
+    else if( key == "spectrumSeed" ) {
+        run.spectrumSeed = std::stoull( value );
+    }
+    else if( key == "modeAmplitudes" ) {
+        run.modeAmplitudes = parseList( value );
+    }
+    else if( key == "modePhases" ) {
+        run.modePhases = parseList( value );
+    }
+    else if( key == "sparseUpdates" ) {
+        if( value != "true" && value != "false" ) {
+            throw std::invalid_argument( "sparseUpdates must be true or false" );
+        }
+        run.sparseUpdates = value == "true";
+    }
+    else if( key == "driveFile" ) {
+        run.driveFile = value;
+    }
+    else if( key == "driveEnds" ) {
+        if( value != "first" && value != "last" && value != "both" ) {
+            throw std::invalid_argument( "driveEnds must be first, last or both" );
+        }
+        run.driveFirst = value != "last";
+        run.driveLast  = value != "first";
+    }
+    else if( key == "driveInterval" ) {
+        run.driveInterval = std::stod( value );
+        if( run.driveInterval <= 0.0 ) {
+            throw std::invalid_argument( "driveInterval must be above 0" );
+        }
+    }
+    else if( key == "driveGain" ) {
+        run.driveGain = std::stod( value );
+    }
+    else if( key == "probePositions" ) {
+        run.probePositions = parseList( value );
+        for( double position : run.probePositions ) {
+            if( position < 0.0 ) {
+                throw std::invalid_argument( "probePositions must be 0 or above" );
+            }
+        }
+    }
+    else if( key == "probePoints" ) {
+        run.probePoints.clear();
+        for( double point : parseList( value ) ) {
+            if( point < 0.0 || point != std::floor( point ) ) {
+                throw std::invalid_argument( "probePoints must be whole numbers from 0" );
+            }
+            run.probePoints.push_back( static_cast<int>( point ) );
+        }
+    }
+    else if( key == "probeInterpolation" ) {
+        if( value != "linear" && value != "nearest" ) {
+            throw std::invalid_argument( "probeInterpolation must be linear or nearest" );
+        }
+        run.probeInterpolation = value;
+    }
+    else if( key == "probeEvery" ) {
+        run.probeEvery = std::stoi( value );
+        if( run.probeEvery < 1 ) {
+            throw std::invalid_argument( "probeEvery must be 1 or above" );
+        }
+    }
+    else if( key == "historyFrames" ) {
+        run.historyFrames = std::stoi( value );
+        if( run.historyFrames != 0 && run.historyFrames <= 2 * historyOverwriteMargin ) {
+            throw std::invalid_argument( std::format( "historyFrames must be 0 or above {}", 2 * historyOverwriteMargin ) );
+        }
+    }
+    else if( key == "fieldLines" ) {
+        run.fieldLines = std::stoi( value );
+        if( run.fieldLines < 1 ) {
+            throw std::invalid_argument( "fieldLines must be 1 or above" );
+        }
+    }
+    else if( key == "displacedLines" ) {
+        run.displacedLines = std::stoi( value );
+        if( run.displacedLines < 1 ) {
+            throw std::invalid_argument( "displacedLines must be 1 or above" );
+        }
+    }
+    else if( key == "driveInterpolation" ) {
+        if( value != "cubic" && value != "sinc" ) {
+            throw std::invalid_argument( "driveInterpolation must be cubic or sinc" );
+        }
+        run.driveInterpolation = value;
+    }
+    else if( key == "offscreen" ) {
+        if( value != "true" && value != "false" ) {
+            throw std::invalid_argument( "offscreen must be true or false" );
+        }
+        run.offscreen = value == "true";
+    }
+    else if( key == "frameInterval" ) {
+        run.frameInterval = std::stod( value );
+        if( run.frameInterval <= 0.0 ) {
+            throw std::invalid_argument( "frameInterval must be above 0" );
+        }
+    }
+    else if( key == "offscreenLength" ) {
+        run.offscreenLength = std::stod( value );
+        if( run.offscreenLength <= 0.0 ) {
+            throw std::invalid_argument( "offscreenLength must be above 0" );
+        }
+    }
+    else {
+        throw std::invalid_argument( "unknown key" );
+    }
+}
+
+std::vector<scenario> loadScenarios( const std::string &fileName ) {
+    // ini style, each [name] starts a new scenario from the defaults, then key = value lines, # starts a comment
+    std::ifstream file( fileName );
+    if( !file ) {
+        std::cerr << std::format( "Error: could not open file, {}\n\n", fileName );
+        abort();
+    }
+    std::vector<scenario> scenarios;
+    std::string           line;
+    int                   lineNumber = 0;
+    while( std::getline( file, line ) ) {
+        lineNumber += 1;
+        line = trim( line.substr( 0, line.find( '#' ) ) );
+        if( line.empty() ) {
+            continue;
+        }
+        if( line.front() == '[' && line.back() == ']' ) {
+            scenarios.push_back( defaultScenario() );
+            scenarios.back().name = trim( line.substr( 1, line.size() - 2 ) );
+            continue;
+        }
+        std::size_t equals = line.find( '=' );
+        if( equals == std::string::npos || scenarios.empty() ) {
+            std::cerr << std::format( "Error: {}:{}, expected [name] or key = value\n\n", fileName, lineNumber );
+            abort();
+        }
+        std::string key   = trim( line.substr( 0, equals ) );
+        std::string value = trim( line.substr( equals + 1 ) );
+        try {
+            setScenarioValue( scenarios.back(), key, value );
+        }
+        catch( const std::exception &error ) {
+            std::cerr << std::format( "Error: {}:{}, {} = {}, {}\n\n", fileName, lineNumber, key, value, error.what() );
+            abort();
+        }
+    }
+    if( scenarios.empty() ) {
+        std::cerr << std::format( "Error: no scenarios in {}\n\n", fileName );
+        abort();
+    }
+    return scenarios;
+}
+
+std::vector<double> createScenarioString( const scenario &run, const double length ) {
+    if( run.shape == "flat" ) {
+        return createString( run.numberOfPoints, length );
+    }
+    if( run.shape == "pulse" ) {
+        return createString( run.numberOfPoints, length, run.height, run.pulseWidth, run.pulseStart );
+    }
+    if( run.shape == "standing" ) {
+        return createString( run.numberOfPoints, run.mode, run.height );
+    }
+    return createString( run.numberOfPoints, length, run.height );
+}
+
+void runJob( const scenario &run, jobResult &result ) {
+    // headless version of the solver thread, runs straight to the end time and saves into its own directory
+    result                 = jobResult{};
+    result.name            = run.name;
+    result.numberOfPoints  = run.numberOfPoints;
+    result.updatedFraction = 1.0;
+    const std::string directory = run.outputDirectory + "/" + run.name;
+    std::filesystem::create_directories( directory );
+    std::ofstream data( directory + "/WavesOnStringsData.dat" );
+    std::ofstream diagnosticsData( directory + "/Diagnostics.bin", std::ios::binary );
+    if( !data || !diagnosticsData ) {
+        result.notes.push_back( std::format( "Error: {}, could not open files in {}", run.name, directory ) );
+        result.failed = true;
+        return;
+    }
+    data << "t\tx\ty\n";
+    diagnosticsData.write( "GUMD", 4 );
+
+    // string
+    const double        latitude = -run.latitudeDegrees * std::numbers::pi / 180.0;
+    std::vector<vec3>   worldPoints;
+    const double        length       = lengthOfMagneticFieldLine( latitude, run.numberOfPoints, worldPoints );
+    const double        deltaLength  = length / ( run.numberOfPoints - 1 );
+    std::vector<double> stringVector;
+    std::vector<double> tension( run.numberOfPoints, 0.0 );
+    std::vector<double> mass( run.numberOfPoints, 0.0 );
+    std::vector<double> velocity( run.numberOfPoints, 0.0 );
+    try {
+        stringVector = createScenarioString( run, length );
+        checkProbes( run, length );
+    }
+    catch( const std::invalid_argument &error ) {
+        result.notes.push_back( std::format( "Error: {}, {}", run.name, error.what() ) );
+        result.failed = true;
+        return;
+    }
+    updateTensionMass( run.numberOfPoints, worldPoints, latitude, tension, mass );
+    if( run.shape == "spectrum" ) {
+        synthesiseSpectrum( run, tension, mass, deltaLength, stringVector, velocity );
+    }
+
+    // autotuning, the time step from the wave speed and the faster double kernel on this machine
+    scenario tuned = run;
+    if( tuned.autoDeltaTime ) {
+        tuned.deltaTime = stableDeltaTime( tension, mass, deltaLength, run.numberOfPoints, run.boundary, run.dampingCoefficient );
+    }
+    if( tuned.kernel == autoKernel ) {
+        tuned.kernel = run.scheme == explicitScheme && run.precision == doublePrecision && !run.sparseUpdates ? tuneKernel( tuned, stringVector, tension, mass, deltaLength, result.notes ) : inPlaceKernel;
+    }
+    if( run.scheme == explicitScheme ) {
+        std::string warning = checkWaveSpeed( tension, mass, tuned.deltaTime, length, run.numberOfPoints );
+        if( !warning.empty() ) {
+            result.notes.push_back( std::format( "{}: {}", run.name, warning ) );
+        }
+    }
+
+    // the implicit solve is only written for double, so it ignores the precision setting
+    if( run.scheme == crankNicolsonScheme && run.precision != doublePrecision ) {
+        result.notes.push_back( std::format( "Note: {} uses crank nicolson, running in double precision", run.name ) );
+    }
+    if( run.scheme == crankNicolsonScheme ) {
+        solveJob<doublePrecision>( tuned, stringVector, velocity, tension, mass, deltaLength, data, diagnosticsData, result );
+    }
+    else if( run.precision == floatPrecision ) {
+        solveJob<floatPrecision>( tuned, stringVector, velocity, tension, mass, deltaLength, data, diagnosticsData, result );
+    }
+    else if( run.precision == floatDoubleAccumulation ) {
+        solveJob<floatDoubleAccumulation>( tuned, stringVector, velocity, tension, mass, deltaLength, data, diagnosticsData, result );
+    }
+    else if( run.precision == floatKahanAccumulation ) {
+        solveJob<floatKahanAccumulation>( tuned, stringVector, velocity, tension, mass, deltaLength, data, diagnosticsData, result );
+    }
+    else {
+        solveJob<doublePrecision>( tuned, stringVector, velocity, tension, mass, deltaLength, data, diagnosticsData, result );
+    }
+}
+
+template <precisionMode mode>
+void solveJob( const scenario &run, std::vector<double> &stringVector, const std::vector<double> &initialVelocity, const std::vector<double> &tension, const std::vector<double> &mass, const double deltaLength, std::ofstream &data, std::ofstream &diagnosticsData, jobResult &result ) {
+    // the job's time loop, double runs use the reference kernels and float runs the in place mixed precision kernel
+    typedef storageType<mode> real;
+    const int           numberOfPoints = run.numberOfPoints;
+    std::vector<double> velocity( initialVelocity );
+
+    // the implicit step couples every point to every other so only explicit runs can skip quiet blocks,
+    // sparse double runs step the in place copy like the float runs do
+    activityMask mask;
+    const bool   sparse  = run.sparseUpdates && run.scheme == explicitScheme;
+    const bool   inPlace = mode != doublePrecision || sparse || ( run.kernel == inPlaceKernel && run.scheme == explicitScheme );
+
+    // the in place copy of the string, only made when it is the one being stepped
+    std::vector<real> state;
+    std::vector<real> stateVelocity;
+    std::vector<real> compensation;
+    std::vector<real> coefficient;
+    std::vector<real> weight;
+    if( inPlace ) {
+        state.assign( stringVector.begin(), stringVector.end() );
+        stateVelocity.assign( initialVelocity.begin(), initialVelocity.end() );
+        compensation.assign( numberOfPoints, real( 0 ) );
+        coefficient.resize( numberOfPoints );
+        weight.resize( numberOfPoints );
+        for( int i = 0; i < numberOfPoints; i++ ) {
+            coefficient[i] = static_cast<real>( tension[i] / ( mass[i] * deltaLength * deltaLength ) );
+            weight[i]      = static_cast<real>( mass[i] * deltaLength / tension[i] );
+        }
+    }
+
+    crankNicolsonOperator implicitOperator;
+    if( run.scheme == crankNicolsonScheme ) {
+        factoriseCrankNicolson( implicitOperator, run.boundary, mass, numberOfPoints, tension, deltaLength, run.deltaTime, run.dampingCoefficient );
+    }
+    if( sparse ) {
+        initialiseActivityMask<mode>( mask, state, stateVelocity, coefficient, numberOfPoints, run.deltaTime );
+    }
+
+    // audio from the pickups, written alongside the data
+    sonification sound;
+    if( !initialiseSonification( sound, run, stringVector, run.outputDirectory + "/" + run.name + "/Audio.wav" ) ) {
+        result.notes.push_back( std::format( "Error: {}, could not open file, {}", run.name, "Audio.wav" ) );
+        result.failed = true;
+        return;
+    }
+
+    // probes, sampled at the start and then every probeEvery steps
+    probeRecorder recorder;
+    if( !initialiseProbes( recorder, run, deltaLength, run.outputDirectory + "/" + run.name + "/Probes.bin" ) ) {
+        result.notes.push_back( std::format( "Error: {}, could not open file, {}", run.name, "Probes.bin" ) );
+        closeSonification( sound );
+        result.failed = true;
+        return;
+    }
+
+    // driven ends follow the time series, they are put where it starts before the first step
+    boundaryDrive drive;
+    double        driveEnds[2]     = { 0.0, 0.0 };
+    double        nextDriveEnds[2] = { 0.0, 0.0 };
+    if( !initialiseDrive( drive, run ) || ( drive.enabled && !nextDriveFrame( drive, driveEnds ) ) ) {
+        result.notes.push_back( std::format( "Error: {}, {}", run.name, drive.error ) );
+        closeDrive( drive );
+        closeProbes( recorder );
+        closeSonification( sound );
+        result.failed = true;
+        return;
+    }
+    if( drive.enabled ) {
+        if( inPlace ) {
+            holdDrivenEnds( drive, state, stateVelocity, driveEnds, driveEnds, run.deltaTime );
+        }
+        holdDrivenEnds( drive, stringVector, velocity, driveEnds, driveEnds, run.deltaTime );
+    }
+    if( inPlace ) {
+        recordProbes( recorder, state, 0.0 );
+    }
+    else {
+        recordProbes( recorder, stringVector, 0.0 );
+    }
+
+    std::queue<bufferData> buffer;
+    stringDiagnostics      diagnostics;
+    double                 time          = 0.0;
+    int                    intTime       = 0;
+    double                 autoSaveTime  = run.autoSaveTime;
+    double                 dampingLoss   = 0.0;
+    double                 initialEnergy = 0.0;
+    auto                   start         = std::chrono::steady_clock::now();
+    while( time + 1e-4 < run.endTime ) {
+        if( autoSaveTime != 0.0 && time + 1e-4 > autoSaveTime ) {
+            writeToFile( buffer, data, deltaLength );
+            autoSaveTime = 0.0;
+        }
+        if( time + 1e-4 >= intTime * run.snapshotInterval ) {
+            if( inPlace ) {
+                std::copy( state.begin(), state.end(), stringVector.begin() );
+            }
+            pushToBuffer( buffer, stringVector, time );
+            intTime += 1;
+        }
+        if( drive.enabled ) {
+            // the step sees the ends where the series has them now, crank nicolson also moves them to where they go next
+            if( !nextDriveFrame( drive, nextDriveEnds ) ) {
+                result.notes.push_back( std::format( "Error: {}, {} at {:.4f}s", run.name, drive.error, time ) );
+                result.failed = true;
+                break;
+            }
+            for( int end = 0; end < 2; end++ ) {
+                implicitOperator.endChange[end] = drive.driven[end] ? nextDriveEnds[end] - driveEnds[end] : 0.0;
+            }
+            if( sparse ) {
+                mask.active[0]               = mask.active[0] || drive.driven[0];
+                mask.active[mask.blocks - 1] = mask.active[mask.blocks - 1] || drive.driven[1];
+            }
+        }
+        if( sparse ) {
+            updateActiveString<mode>( mask, run.boundary, state, stateVelocity, compensation, coefficient, weight, numberOfPoints, run.deltaTime, run.dampingCoefficient, diagnostics );
+        }
+        else if constexpr( mode == doublePrecision ) {
+            if( run.scheme == crankNicolsonScheme ) {
+                updateCrankNicolsonString( implicitOperator, stringVector, velocity, mass, numberOfPoints, tension, deltaLength, diagnostics );
+            }
+            else if( inPlace ) {
+                updateMixedString<mode>( run.boundary, state, stateVelocity, compensation, coefficient, weight, numberOfPoints, run.deltaTime, run.dampingCoefficient, diagnostics );
+            }
+            else {
+                updateString( run.boundary, stringVector, velocity, mass, numberOfPoints, tension, deltaLength, run.deltaTime, run.dampingCoefficient, diagnostics );
+            }
+        }
+        else {
+            updateMixedString<mode>( run.boundary, state, stateVelocity, compensation, coefficient, weight, numberOfPoints, run.deltaTime, run.dampingCoefficient, diagnostics );
+        }
+        if( drive.enabled ) {
+            if( inPlace ) {
+                holdDrivenEnds( drive, state, stateVelocity, nextDriveEnds, driveEnds, run.deltaTime );
+            }
+            else {
+                holdDrivenEnds( drive, stringVector, velocity, nextDriveEnds, driveEnds, run.deltaTime );
+            }
+            driveEnds[0] = nextDriveEnds[0];
+            driveEnds[1] = nextDriveEnds[1];
+        }
+        time += run.deltaTime;
+        result.steps += 1;
+        dampingLoss += diagnostics.dampingLoss;
+        writeDiagnostics( diagnosticsData, diagnostics, time, dampingLoss );
+        // a driven string gains the energy put in at its ends, so only a non finite string counts as blown up
+        const bool blownUp = drive.enabled ? !std::isfinite( diagnostics.kineticEnergy + diagnostics.potentialEnergy ) || !std::isfinite( diagnostics.maxDisplacement ) : isUnstable( diagnostics, result.steps, initialEnergy );
+        if( blownUp ) {
+            result.notes.push_back( std::format( "Error: {} unstable at {:.4f}s, check the time step against the wave speed", run.name, time ) );
+            result.unstable = true;
+            break;
+        }
+        if( sound.enabled ) {
+            if constexpr( mode == doublePrecision ) {
+                pushSonification( sound, inPlace ? state : stringVector );
+            }
+            else {
+                pushSonification( sound, state );
+            }
+        }
+        if( recorder.enabled ) {
+            if( inPlace ) {
+                recordProbes( recorder, state, time );
+            }
+            else {
+                recordProbes( recorder, stringVector, time );
+            }
+        }
+    }
+    closeDrive( drive );
+    closeProbes( recorder );
+    closeSonification( sound );
+    if( sound.enabled && sound.wav.clipped > 0 ) {
+        result.notes.push_back( std::format( "Note: {} went past full scale in {} audio samples, lower audioGain", run.name, sound.wav.clipped ) );
+    }
+    std::chrono::duration<double> wallTime = std::chrono::steady_clock::now() - start;
+    result.simulatedTime                   = time;
+    result.wallTime                        = wallTime.count();
+    if( sparse && result.steps > 0 ) {
+        result.updatedFraction = static_cast<double>( mask.pointUpdates ) / ( static_cast<double>( result.steps ) * numberOfPoints );
+    }
+    // the last snapshots are always kept
+    if( inPlace ) {
+        std::copy( state.begin(), state.end(), stringVector.begin() );
+    }
+    pushToBuffer( buffer, stringVector, time );
+    writeToFile( buffer, data, deltaLength );
+}
+
+void tuneJobs( const std::vector<scenario> &scenarios ) {
+    // kernel = auto jobs are timed here one at a time before the workers start, so no trial runs alongside other jobs and each
+    // machine, size and boundary is only timed and saved once, runJob then finds the result in Autotune.dat
+    for( const scenario &run : scenarios ) {
+        if( run.kernel != autoKernel || run.scheme != explicitScheme || run.precision != doublePrecision || run.sparseUpdates ) {
+            continue;
+        }
+        const double        latitude = -run.latitudeDegrees * std::numbers::pi / 180.0;
+        std::vector<vec3>   worldPoints;
+        const double        length      = lengthOfMagneticFieldLine( latitude, run.numberOfPoints, worldPoints );
+        const double        deltaLength = length / ( run.numberOfPoints - 1 );
+        std::vector<double> stringVector;
+        std::vector<double> tension( run.numberOfPoints, 0.0 );
+        std::vector<double> mass( run.numberOfPoints, 0.0 );
+        std::vector<double> velocity( run.numberOfPoints, 0.0 );
+        try {
+            stringVector = createScenarioString( run, length );
+        }
+        catch( const std::invalid_argument & ) {
+            continue; // runJob reports it
+        }
+        updateTensionMass( run.numberOfPoints, worldPoints, latitude, tension, mass );
+        if( run.shape == "spectrum" ) {
+            synthesiseSpectrum( run, tension, mass, deltaLength, stringVector, velocity );
+        }
+        scenario tuned = run;
+        if( tuned.autoDeltaTime ) {
+            tuned.deltaTime = stableDeltaTime( tension, mass, deltaLength, run.numberOfPoints, run.boundary, run.dampingCoefficient );
+        }
+        std::filesystem::create_directories( run.outputDirectory ); // Autotune.dat is saved there before any job has made it
+        std::vector<std::string> notes;
+        tuneKernel( tuned, stringVector, tension, mass, deltaLength, notes );
+        for( const std::string &note : notes ) {
+            std::cout << std::format( "{}: {}", run.name, note ) << std::endl;
+        }
+    }
+}
+
+void runJobs( const std::vector<scenario> &scenarios, const int threads ) {
+    // each worker takes the next job until there are none left, jobs are independent so nothing else is shared
+    tuneJobs( scenarios );
+    std::vector<jobResult>   results( scenarios.size() );
+    std::atomic<int>         nextJob     = 0;
+    std::mutex               noteMutex; // each job's notes are printed together as it finishes
+    std::vector<std::thread> workers;
+    auto                     start       = std::chrono::steady_clock::now();
+    const int                workerCount = std::clamp( threads, 1, static_cast<int>( scenarios.size() ) );
+    for( int i = 0; i < workerCount; i++ ) {
+        workers.emplace_back( [&scenarios, &results, &nextJob, &noteMutex] {
+            for( int job = nextJob++; job < static_cast<int>( scenarios.size() ); job = nextJob++ ) {
+                runJob( scenarios[job], results[job] );
+                std::lock_guard<std::mutex> lock( noteMutex );
+                for( const std::string &note : results[job].notes ) {
+                    ( note.starts_with( "Error" ) ? std::cerr : std::cout ) << note << std::endl;
+                }
+            }
+        } );
+    }
+    for( std::thread &worker : workers ) {
+        worker.join();
+    }
+    std::chrono::duration<double> totalTime = std::chrono::steady_clock::now() - start;
+
+    // summary table, also saved next to the first job's output
+    const std::string summaryName = scenarios.front().outputDirectory + "/JobSummary.dat";
+    std::ofstream     summary( summaryName );
+    std::string       header = "name\tpoints\tsteps\tsimulated (s)\twall (s)\tpoint updates/s\tsimulated/wall\tupdated\tstatus\n";
+    std::cout << header;
+    summary << header;
+    for( const jobResult &result : results ) {
+        const double wallTime = std::max( result.wallTime, 1e-9 );
+        std::string  status   = result.failed ? "failed" : result.unstable ? "unstable" : "ok";
+        std::string  row      = std::format( "{}\t{}\t{}\t{:.3f}\t{:.3f}\t{:.3e}\t{:.2f}\t{:.3f}\t{}\n", result.name, result.numberOfPoints, result.steps, result.simulatedTime, result.wallTime, result.steps * static_cast<double>( result.numberOfPoints ) / wallTime, result.simulatedTime / wallTime, result.updatedFraction, status );
+        std::cout << row;
+        summary << row;
+    }
+    // the notes go under the table as comments so it still loads as a table
+    for( const jobResult &result : results ) {
+        for( const std::string &note : result.notes ) {
+            summary << "# " << note << "\n";
+        }
+    }
+    std::cout << std::format( "{} jobs on {} threads in {:.2f}s, summary saved to {}", results.size(), workerCount, totalTime.count(), summaryName ) << std::endl;
+}
+
+// autotune functions
+// ------------------
+
+double stableDeltaTime( const std::vector<double> &tension, const std::vector<double> &mass, const double deltaLength, const int numberOfPoints, const stringBoundary boundary, const double dampingCoefficient ) {
+    // the explicit step is stable while the fastest wave crosses under a point per step, damped ends also need damping * dt under 2
+    double fastest = 0.0; // (meters/seccond)
+    for( int i = 0; i < numberOfPoints; i++ ) {
+        fastest = std::max( fastest, std::sqrt( tension[i] / mass[i] ) );
+    }
+    double limit = deltaLength / fastest;
+    if( boundary == dampedEnds && dampingCoefficient > 0.0 ) {
+        limit = std::min( limit, 2.0 / dampingCoefficient );
+    }
+    return autotuneSafety * limit;
+}
+
+std::string autotuneMachine() {
+    // host name and core count, enough to keep caches on a shared data directory apart
+    char name[256] = {};
+    if( gethostname( name, sizeof( name ) - 1 ) != 0 ) {
+        std::strcpy( name, "unknown" );
+    }
+    return std::format( "{}-{}", name, std::thread::hardware_concurrency() );
+}
+
+bool loadAutotune( const std::string &fileName, const std::string &key, std::string &value ) {
+    // lines of machine, key and value separated by tabs, the last line for a machine and key wins
+    std::lock_guard<std::mutex> lock( autotuneMutex );
+    std::ifstream               file( fileName );
+    const std::string           prefix = autotuneMachine() + "\t" + key + "\t";
+    std::string                 line;
+    bool                        found = false;
+    while( std::getline( file, line ) ) {
+        if( line.starts_with( prefix ) ) {
+            value = line.substr( prefix.size() );
+            found = true;
+        }
+    }
+    return found;
+}
+
+void saveAutotune( const std::string &fileName, const std::string &key, const std::string &value ) {
+    std::lock_guard<std::mutex> lock( autotuneMutex );
+    std::ofstream               file( fileName, std::ios::app );
+    file << autotuneMachine() << "\t" << key << "\t" << value << "\n";
+}
+
+stringKernel tuneKernel( const scenario &run, const std::vector<double> &stringVector, const std::vector<double> &tension, const std::vector<double> &mass, const double deltaLength, std::vector<std::string> &notes ) {
+    // times the reference and in place double kernels on copies of the real string, cached per machine, size and boundary
+    const std::string cacheName = run.outputDirectory + "/Autotune.dat";
+    const std::string key       = std::format( "kernel {} {}", run.numberOfPoints, static_cast<int>( run.boundary ) );
+    std::string       cached;
+    if( loadAutotune( cacheName, key, cached ) ) {
+        return cached == "inPlace" ? inPlaceKernel : referenceKernel;
+    }
+    const int           numberOfPoints = run.numberOfPoints;
+    std::vector<double> coefficient( numberOfPoints );
+    std::vector<double> weight( numberOfPoints );
+    for( int i = 0; i < numberOfPoints; i++ ) {
+        coefficient[i] = tension[i] / ( mass[i] * deltaLength * deltaLength );
+        weight[i]      = mass[i] * deltaLength / tension[i];
+    }
+    double rates[2];
+    for( int kernel = referenceKernel; kernel <= inPlaceKernel; kernel++ ) {
+        std::vector<double>           trial = stringVector;
+        std::vector<double>           velocity( numberOfPoints, 0.0 );
+        std::vector<double>           compensation( numberOfPoints, 0.0 );
+        stringDiagnostics             diagnostics;
+        long long                     steps = 0;
+        auto                          start = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed( 0.0 );
+        while( elapsed.count() < autotuneTrialTime ) {
+            if( kernel == referenceKernel ) {
+                updateString( run.boundary, trial, velocity, mass, numberOfPoints, tension, deltaLength, run.deltaTime, run.dampingCoefficient, diagnostics );
+            }
+            else {
+                updateMixedString<doublePrecision>( run.boundary, trial, velocity, compensation, coefficient, weight, numberOfPoints, run.deltaTime, run.dampingCoefficient, diagnostics );
+            }
+            steps += 1;
+            elapsed = std::chrono::steady_clock::now() - start;
+        }
+        rates[kernel] = steps / elapsed.count();
+    }
+    const stringKernel fastest = rates[inPlaceKernel] > rates[referenceKernel] ? inPlaceKernel : referenceKernel;
+    notes.push_back( std::format( "Autotune: {} points, reference {:.0f} steps/s, in place {:.0f} steps/s", numberOfPoints, rates[referenceKernel], rates[inPlaceKernel] ) );
+    saveAutotune( cacheName, key, fastest == inPlaceKernel ? "inPlace" : "reference" );
+    return fastest;
+}
+
+// history functions
+// -----------------
+
+bool openHistory( historyFile &history, const std::string &fileName, const int numberOfPoints, const long long capacity ) {
+    // the history thread writes with pwrite and the viewer maps the file, both go through the page cache so mapped frames are always current,
+    // the file never grows past capacity frames
+    history.numberOfPoints = numberOfPoints;
+    history.capacity       = capacity;
+    history.recordBytes    = ( numberOfPoints + 1 ) * sizeof( double );
+    history.frames         = 0;
+    history.queued         = 0;
+    history.finished       = false;
+    history.failed         = false;
+    history.map            = NULL;
+    history.mappedBytes    = 0;
+    history.prefetched     = -historyPrefetchFrames;
+    history.descriptor     = open( fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+    if( history.descriptor < 0 ) {
+        return false;
+    }
+    char header[historyHeaderBytes];
+    std::memcpy( header, "GUMH", 4 );
+    const std::int32_t points = numberOfPoints;
+    const std::int64_t slots  = capacity;
+    std::memcpy( header + 4, &points, sizeof( points ) );
+    std::memcpy( header + 8, &historyInterval, sizeof( historyInterval ) );
+    std::memcpy( header + 16, &slots, sizeof( slots ) );
+    return write( history.descriptor, header, historyHeaderBytes ) == static_cast<ssize_t>( historyHeaderBytes );
+}
+
+void queueHistory( historyFile &history, const std::vector<double> &stringVector, const double time ) {
+    // solver thread, copies the frame for the history thread and only waits when it is historyQueueFrames behind
+    std::vector<double> record( history.numberOfPoints + 1 );
+    record[0] = time;
+    std::copy( stringVector.begin(), stringVector.begin() + history.numberOfPoints, record.begin() + 1 );
+    {
+        std::unique_lock<std::mutex> lock( history.mutex );
+        history.condition.wait( lock, [&history] { return history.pending.size() < historyQueueFrames; } );
+        history.pending.push( std::move( record ) );
+    }
+    history.condition.notify_all();
+    history.queued += 1;
+}
+
+void writeHistory( historyFile &history ) {
+    // history thread, writes each record over the oldest slot, the frame count is only published once the whole record is in the file
+    TRACE_THREAD( "history writer" );
+    while( true ) {
+        std::vector<double> record;
+        {
+            std::unique_lock<std::mutex> lock( history.mutex );
+            history.condition.wait( lock, [&history] { return !history.pending.empty() || history.finished; } );
+            if( history.pending.empty() ) {
+                return;
+            }
+            record = std::move( history.pending.front() );
+            history.pending.pop();
+        }
+        history.condition.notify_all();
+        if( history.failed ) {
+            continue; // drains the queue so the solver never waits on it
+        }
+        TRACE_ZONE( "write history" );
+        const long long frame  = history.frames.load( std::memory_order_relaxed );
+        const off_t     offset = historyHeaderBytes + ( frame % history.capacity ) * history.recordBytes;
+        if( pwrite( history.descriptor, record.data(), history.recordBytes, offset ) != static_cast<ssize_t>( history.recordBytes ) ) {
+            std::cerr << std::format( "Error: could not write to the history at {:.2f}s, it stops here\n\n", record[0] );
+            history.failed = true;
+            continue;
+        }
+        history.frames.fetch_add( 1, std::memory_order_release );
+    }
+}
+
+void finishHistory( historyFile &history ) {
+    // the history thread writes what is queued then returns
+    {
+        std::lock_guard<std::mutex> lock( history.mutex );
+        history.finished = true;
+    }
+    history.condition.notify_all();
+}
+
+long long firstHistoryFrame( const historyFile &history, const long long frames ) {
+    // oldest frame that can be shown, once the ring has wrapped the next few slots are about to be written over
+    return frames > history.capacity ? frames - history.capacity + historyOverwriteMargin : 0;
+}
+
+bool mapHistory( historyFile &history ) {
+    // the whole ring is mapped once, past the end of the file while it is still filling, only written frames are ever read
+    const long long frames = history.frames.load( std::memory_order_acquire );
+    if( frames == 0 ) {
+        return false;
+    }
+    if( history.map != NULL ) {
+        return true;
+    }
+    history.mappedBytes = historyHeaderBytes + history.capacity * history.recordBytes;
+    void *map           = mmap( NULL, history.mappedBytes, PROT_READ, MAP_SHARED, history.descriptor, 0 );
+    if( map == MAP_FAILED ) {
+        history.map = NULL;
+        return false;
+    }
+    // scrubbing jumps around so the kernel's own read ahead is turned off, prefetchHistory reads ahead in the playback direction
+    madvise( map, history.mappedBytes, MADV_RANDOM );
+    history.map        = static_cast<const char *>( map );
+    history.prefetched = -historyPrefetchFrames;
+    return true;
+}
+
+const double *historyFrame( const historyFile &history, const long long frame ) {
+    // time then the string, the records are 8 byte aligned as the header is 24 bytes
+    return reinterpret_cast<const double *>( history.map + historyHeaderBytes + ( frame % history.capacity ) * history.recordBytes );
+}
+
+void prefetchHistory( historyFile &history, const long long frame, const int direction ) {
+    // asks for the next historyPrefetchFrames frames the way playback is going, again once half of them have been shown
+    if( direction == 0 || std::abs( frame - history.prefetched ) < historyPrefetchFrames / 2 ) {
+        return;
+    }
+    const long long   frames   = history.frames.load( std::memory_order_acquire );
+    const long long   oldest   = firstHistoryFrame( history, frames );
+    const long long   first    = std::clamp( direction > 0 ? frame : frame - historyPrefetchFrames, oldest, frames - 1 );
+    const long long   last     = std::clamp( direction > 0 ? frame + historyPrefetchFrames : frame, oldest, frames - 1 );
+    const std::size_t pageSize = sysconf( _SC_PAGESIZE );
+    // the frames are contiguous in the file unless they run over the end of the ring, then each side is read in
+    for( long long from = first; from <= last; ) {
+        const long long   to    = std::min( last, from - from % history.capacity + history.capacity - 1 );
+        const std::size_t start = ( historyHeaderBytes + ( from % history.capacity ) * history.recordBytes ) / pageSize * pageSize;
+        const std::size_t end   = historyHeaderBytes + ( to % history.capacity + 1 ) * history.recordBytes;
+        madvise( const_cast<char *>( history.map ) + start, end - start, MADV_WILLNEED );
+        from = to + 1;
+    }
+    history.prefetched = frame;
+}
+
+void closeHistory( historyFile &history ) {
+    if( history.map != NULL ) {
+        munmap( const_cast<char *>( history.map ), history.mappedBytes );
+        history.map = NULL;
+    }
+    if( history.descriptor >= 0 ) {
+        close( history.descriptor );
+        history.descriptor = -1;
+    }
+}
+
+// audio functions
+// ---------------
+
+void initialiseResampler( polyphaseResampler &resampler, const int channels, const double inputRate, const double outputRate ) {
+    // windowed sinc bank, the cutoff sits under the lower of the two nyquist rates so nothing folds back when decimating
+    const double cutoff = resamplerPassband * std::min( 1.0, outputRate / inputRate ); // relative to the input nyquist rate
+    resampler.channels  = channels;
+    resampler.taps      = 2 * static_cast<int>( std::ceil( resamplerZeroCrossings / cutoff ) );
+    resampler.step      = inputRate / outputRate;
+    resampler.position  = 0.0;
+    resampler.inputs    = 0;
+    resampler.filter.assign( ( resamplerPhases + 1 ) * resampler.taps, 0.0 );
+    resampler.history.assign( channels * 2 * resampler.taps, 0.0 );
+    const double halfWidth = resampler.taps / 2.0;
+    for( int phase = 0; phase <= resamplerPhases; phase++ ) {
+        // tap j sits at j - taps / 2 + 1 - fraction input samples from the output
+        const double fraction = static_cast<double>( phase ) / resamplerPhases;
+        double      *row      = resampler.filter.data() + phase * resampler.taps;
+        double       sum      = 0.0;
+        for( int j = 0; j < resampler.taps; j++ ) {
+            const double distance = j - halfWidth + 1.0 - fraction;
+            const double x        = std::numbers::pi * cutoff * distance;
+            const double sinc     = std::abs( x ) < 1e-12 ? 1.0 : std::sin( x ) / x;
+            const double u        = distance / halfWidth;
+            const double window   = std::abs( u ) >= 1.0 ? 0.0 : 0.42 + 0.5 * std::cos( std::numbers::pi * u ) + 0.08 * std::cos( 2.0 * std::numbers::pi * u );
+            row[j]                = cutoff * sinc * window;
+            sum += row[j];
+        }
+        // unity gain at dc for every phase, otherwise the phases ripple against each other
+        for( int j = 0; j < resampler.taps; j++ ) {
+            row[j] /= sum;
+        }
+    }
+}
+
+void pushResampler( polyphaseResampler &resampler, const double *frame, std::vector<double> &output ) {
+    // adds one input frame and appends every output frame it completes, interleaved
+    const int taps  = resampler.taps;
+    const int index = static_cast<int>( resampler.inputs % taps );
+    for( int channel = 0; channel < resampler.channels; channel++ ) {
+        // each channel's history is written twice so the newest taps samples are always contiguous
+        double *history        = resampler.history.data() + channel * 2 * taps;
+        history[index]         = frame[channel];
+        history[index + taps]  = frame[channel];
+    }
+    resampler.inputs += 1;
+    // an output at input time t needs samples up to floor( t ) + taps / 2
+    const long long newest = resampler.inputs - 1;
+    while( static_cast<long long>( resampler.position ) + taps / 2 <= newest ) {
+        const double  fraction = ( resampler.position - std::floor( resampler.position ) ) * resamplerPhases;
+        const int     phase    = static_cast<int>( fraction );
+        const double  blend    = fraction - phase;
+        const double *lower    = resampler.filter.data() + phase * taps;
+        const double *upper    = lower + taps;
+        for( int channel = 0; channel < resampler.channels; channel++ ) {
+            const double *window = resampler.history.data() + channel * 2 * taps + index + 1;
+            double        a      = 0.0;
+            double        b      = 0.0;
+            for( int j = 0; j < taps; j++ ) {
+                a += lower[j] * window[j];
+                b += upper[j] * window[j];
+            }
+            output.push_back( a + ( b - a ) * blend );
+        }
+        resampler.position += resampler.step;
+    }
+}
+
+bool openWav( wavWriter &wav, const std::string &fileName, const int channels, const int sampleRate, const std::string &format ) {
+    // the sizes are left at 0 and filled in by closeWav, so the file can be streamed
+    wav.file.open( fileName, std::ios::binary );
+    if( !wav.file ) {
+        return false;
+    }
+    wav.channels       = channels;
+    wav.sampleRate     = sampleRate;
+    wav.floatSamples   = format == "float";
+    wav.bytesPerSample = format == "pcm16" ? 2 : format == "pcm24" ? 3 : 4;
+    wav.frames         = 0;
+    wav.clipped        = 0;
+    const uint16_t formatTag     = wav.floatSamples ? 3 : 1;
+    const uint16_t channelCount  = static_cast<uint16_t>( channels );
+    const uint32_t rate          = static_cast<uint32_t>( sampleRate );
+    const uint16_t blockAlign    = static_cast<uint16_t>( channels * wav.bytesPerSample );
+    const uint32_t byteRate      = rate * blockAlign;
+    const uint16_t bitsPerSample = static_cast<uint16_t>( 8 * wav.bytesPerSample );
+    const uint32_t zero          = 0;
+    const uint32_t formatSize    = 16;
+    wav.file.write( "RIFF", 4 );
+    wav.file.write( reinterpret_cast<const char *>( &zero ), 4 );
+    wav.file.write( "WAVEfmt ", 8 );
+    wav.file.write( reinterpret_cast<const char *>( &formatSize ), 4 );
+    wav.file.write( reinterpret_cast<const char *>( &formatTag ), 2 );
+    wav.file.write( reinterpret_cast<const char *>( &channelCount ), 2 );
+    wav.file.write( reinterpret_cast<const char *>( &rate ), 4 );
+    wav.file.write( reinterpret_cast<const char *>( &byteRate ), 4 );
+    wav.file.write( reinterpret_cast<const char *>( &blockAlign ), 2 );
+    wav.file.write( reinterpret_cast<const char *>( &bitsPerSample ), 2 );
+    wav.file.write( "data", 4 );
+    wav.file.write( reinterpret_cast<const char *>( &zero ), 4 );
+    return true;
+}
+
+void writeWavFrames( wavWriter &wav, const std::vector<double> &samples ) {
+    // little endian samples, pcm is clipped to full scale
+    std::vector<char> bytes( samples.size() * wav.bytesPerSample );
+    char             *out = bytes.data();
+    for( double sample : samples ) {
+        if( std::abs( sample ) > 1.0 ) {
+            wav.clipped += 1;
+        }
+        if( wav.floatSamples ) {
+            const float value = static_cast<float>( sample );
+            std::memcpy( out, &value, 4 );
+        }
+        else {
+            const double  scale = wav.bytesPerSample == 2 ? 32767.0 : 8388607.0;
+            const int32_t value = static_cast<int32_t>( std::lround( std::clamp( sample, -1.0, 1.0 ) * scale ) );
+            for( int byte = 0; byte < wav.bytesPerSample; byte++ ) {
+                out[byte] = static_cast<char>( ( value >> ( 8 * byte ) ) & 0xff );
+            }
+        }
+        out += wav.bytesPerSample;
+    }
+    wav.file.write( bytes.data(), bytes.size() );
+    wav.frames += samples.size() / wav.channels;
+}
+
+void closeWav( wavWriter &wav ) {
+    // goes back and fills in the riff and data sizes now the length is known
+    const uint32_t dataSize = static_cast<uint32_t>( wav.frames * wav.channels * wav.bytesPerSample );
+    const uint32_t riffSize = 36 + dataSize;
+    wav.file.seekp( 4 );
+    wav.file.write( reinterpret_cast<const char *>( &riffSize ), 4 );
+    wav.file.seekp( 40 );
+    wav.file.write( reinterpret_cast<const char *>( &dataSize ), 4 );
+    wav.file.close();
+}
+
+bool initialiseSonification( sonification &sound, const scenario &run, const std::vector<double> &stringVector, const std::string &fileName ) {
+    // one channel per pickup, the solver's step rate is sped up by audioSpeedUp then resampled to the audio rate
+    sound.enabled = !run.pickups.empty();
+    if( !sound.enabled ) {
+        return true;
+    }
+    const int channels = static_cast<int>( run.pickups.size() );
+    if( !openWav( sound.wav, fileName, channels, run.audioSampleRate, run.audioFormat ) ) {
+        return false;
+    }
+    const double inputRate = run.audioSpeedUp / run.deltaTime;
+    initialiseResampler( sound.resampler, channels, inputRate, run.audioSampleRate );
+    sound.pickupIndex.resize( channels );
+    sound.pickupFraction.resize( channels );
+    for( int channel = 0; channel < channels; channel++ ) {
+        const double position          = std::clamp( run.pickups[channel], 0.0, 1.0 ) * ( run.numberOfPoints - 1 );
+        sound.pickupIndex[channel]    = std::min( static_cast<int>( position ), run.numberOfPoints - 2 );
+        sound.pickupFraction[channel] = position - sound.pickupIndex[channel];
+    }
+    // an undriven string only holds the energy it starts with, so its largest displacement sets full scale,
+    // a flat string has nothing to go on so full scale follows the loudest output so far and only ever gets quieter
+    double largest = 0.0;
+    for( double y : stringVector ) {
+        largest = std::max( largest, std::abs( y ) );
+    }
+    sound.audioGain        = run.audioGain;
+    sound.runningPeak      = largest == 0.0;
+    sound.peak             = 0.0;
+    sound.gain             = sound.runningPeak ? 0.0 : run.audioGain / largest;
+    sound.highPass         = 1.0 / ( 1.0 + 2.0 * std::numbers::pi * audioHighPassFrequency / inputRate );
+    sound.previousInput.assign( channels, 0.0 );
+    sound.previousOutput.assign( channels, 0.0 );
+    for( int channel = 0; channel < channels; channel++ ) {
+        // starts the dc blocker on the first sample so the audio doesnt open with a click
+        const int i                  = sound.pickupIndex[channel];
+        sound.previousInput[channel] = stringVector[i] + ( stringVector[i + 1] - stringVector[i] ) * sound.pickupFraction[channel];
+    }
+    sound.frame.assign( channels, 0.0 );
+    sound.block.clear();
+    sound.block.reserve( 2 * audioBlockFrames * channels );
+    return true;
+}
+
+template <typename real>
+void pushSonification( sonification &sound, const std::vector<real> &stringVector ) {
+    // samples each pickup between its two nearest points, takes off the dc and writes whole blocks as they fill
+    for( int channel = 0; channel < sound.resampler.channels; channel++ ) {
+        const int    i      = sound.pickupIndex[channel];
+        const double input  = stringVector[i] + ( static_cast<double>( stringVector[i + 1] ) - stringVector[i] ) * sound.pickupFraction[channel];
+        const double output = sound.highPass * ( sound.previousOutput[channel] + input - sound.previousInput[channel] );
+        sound.previousInput[channel]  = input;
+        sound.previousOutput[channel] = output;
+        if( sound.runningPeak && std::abs( output ) > sound.peak ) {
+            sound.peak = std::abs( output );
+            sound.gain = sound.audioGain / sound.peak;
+        }
+    }
+    // every channel of a frame is scaled alike so the pickups keep their balance
+    for( int channel = 0; channel < sound.resampler.channels; channel++ ) {
+        sound.frame[channel] = sound.previousOutput[channel] * sound.gain;
+    }
+    pushResampler( sound.resampler, sound.frame.data(), sound.block );
+    if( static_cast<int>( sound.block.size() ) >= audioBlockFrames * sound.resampler.channels ) {
+        writeWavFrames( sound.wav, sound.block );
+        sound.block.clear();
+    }
+}
+
+void closeSonification( sonification &sound ) {
+    // pushes silence through so the last samples clear the filter, then finishes the file
+    if( !sound.enabled ) {
+        return;
+    }
+    std::fill( sound.frame.begin(), sound.frame.end(), 0.0 );
+    for( int i = 0; i < sound.resampler.taps / 2; i++ ) {
+        pushResampler( sound.resampler, sound.frame.data(), sound.block );
+    }
+    writeWavFrames( sound.wav, sound.block );
+    sound.block.clear();
+    closeWav( sound.wav );
+}
+
+// probe functions
+// ---------------
+
+void checkProbes( const scenario &run, const double length ) {
+    // the line length is only known once the latitude is, so this cant be checked as the keys are read
+    for( double distance : run.probePositions ) {
+        if( distance > length ) {
+            throw std::invalid_argument( std::format( "probe position {:.3e}m is off the {:.3e}m line", distance, length ) );
+        }
+    }
+    for( int point : run.probePoints ) {
+        if( point > run.numberOfPoints - 1 ) {
+            throw std::invalid_argument( std::format( "probe point {} is past the last point, {}", point, run.numberOfPoints - 1 ) );
+        }
+    }
+}
+
+bool initialiseProbes( probeRecorder &recorder, const scenario &run, const double deltaLength, const std::string &fileName ) {
+    // Probes.bin is "GUMP", int32 number of probes, int32 probeEvery, float64 deltaTime, float64 position of each probe (meters),
+    // then blocks of int32 frames, float64 time of each frame and float64 displacement of each frame for each probe in turn,
+    // the probes have been through checkProbes so they are all on the line
+    recorder.enabled = !run.probePositions.empty() || !run.probePoints.empty();
+    if( !recorder.enabled ) {
+        return true;
+    }
+    recorder.file.open( fileName, std::ios::binary );
+    if( !recorder.file ) {
+        recorder.enabled = false;
+        return false;
+    }
+    const int           last = run.numberOfPoints - 1;
+    std::vector<double> positions;
+    recorder.index.clear();
+    recorder.fraction.clear();
+    for( double distance : run.probePositions ) {
+        double position = std::min( distance / deltaLength, static_cast<double>( last ) ); // the far end can divide to just past the last point
+        if( run.probeInterpolation == "nearest" ) {
+            position = std::round( position );
+        }
+        const int i = std::min( static_cast<int>( position ), last - 1 );
+        recorder.index.push_back( i );
+        recorder.fraction.push_back( position - i );
+        positions.push_back( position * deltaLength );
+    }
+    for( int point : run.probePoints ) {
+        recorder.index.push_back( point );
+        recorder.fraction.push_back( 0.0 );
+        positions.push_back( point * deltaLength );
+    }
+    recorder.probes = static_cast<int>( recorder.index.size() );
+    recorder.every  = run.probeEvery;
+    recorder.steps  = 0;
+    recorder.frames = 0;
+    recorder.times.assign( probeBlockFrames, 0.0 );
+    recorder.values.assign( static_cast<std::size_t>( recorder.probes ) * probeBlockFrames, 0.0 );
+
+    const std::int32_t probes = recorder.probes;
+    const std::int32_t every  = recorder.every;
+    recorder.file.write( "GUMP", 4 );
+    recorder.file.write( reinterpret_cast<const char *>( &probes ), sizeof( probes ) );
+    recorder.file.write( reinterpret_cast<const char *>( &every ), sizeof( every ) );
+    recorder.file.write( reinterpret_cast<const char *>( &run.deltaTime ), sizeof( run.deltaTime ) );
+    recorder.file.write( reinterpret_cast<const char *>( positions.data() ), positions.size() * sizeof( double ) );
+    return true;
+}
 
-        if( radius <= radiusEarth ) {
-            break;
-        }
+template <typename real>
+void recordProbes( probeRecorder &recorder, const std::vector<real> &stringVector, const double time ) {
+    // called every step, only every probeEvery'th is kept, a full block is written in one go
+    if( !recorder.enabled ) {
+        return;
+    }
+    const bool sample = recorder.steps % recorder.every == 0;
+    recorder.steps += 1;
+    if( !sample ) {
+        return;
+    }
+    const int frame       = recorder.frames;
+    recorder.times[frame] = time;
+    for( int probe = 0; probe < recorder.probes; probe++ ) {
+        const int    i      = recorder.index[probe];
+        const double y      = stringVector[i];
+        const double next   = recorder.fraction[probe] != 0.0 ? static_cast<double>( stringVector[i + 1] ) : y;
+        recorder.values[static_cast<std::size_t>( probe ) * probeBlockFrames + frame] = y + ( next - y ) * recorder.fraction[probe];
     }
+    recorder.frames += 1;
+    if( recorder.frames == probeBlockFrames ) {
+        writeProbeBlock( recorder );
+    }
+}
 
-    for( int i = 0; i < numberOfPoints; ++i ) {
-        int index = i * ( points.size() - 1 ) / ( numberOfPoints - 1 );
-        worldPoints.push_back( points[index] );
+void writeProbeBlock( probeRecorder &recorder ) {
+    // the frames buffered so far, each probe's row is written as one run
+    if( recorder.frames == 0 ) {
+        return;
+    }
+    const std::int32_t frames = recorder.frames;
+    recorder.file.write( reinterpret_cast<const char *>( &frames ), sizeof( frames ) );
+    recorder.file.write( reinterpret_cast<const char *>( recorder.times.data() ), frames * sizeof( double ) );
+    for( int probe = 0; probe < recorder.probes; probe++ ) {
+        recorder.file.write( reinterpret_cast<const char *>( recorder.values.data() + static_cast<std::size_t>( probe ) * probeBlockFrames ), frames * sizeof( double ) );
     }
+    recorder.frames = 0;
+}
 
-    return length;
+void closeProbes( probeRecorder &recorder ) {
+    if( !recorder.enabled ) {
+        return;
+    }
+    writeProbeBlock( recorder );
+    recorder.file.close();
 }
 
-// miscellaneous functions
-// -----------------------
+// boundary driving functions
+// --------------------------
 
-void makeAxisTicks( point *axisTicks, int numberOfTicks, float tickSize, GLFWwindow *window ) {
-    // window width and height
-    int width;
-    int height;
-    glfwGetFramebufferSize( window, &width, &height );
-    // aspect ratio for equivilent sized ticks
-    float aspectRatio = static_cast<float>( width ) / static_cast<float>( height );
-    int   i           = 0;
-    for( int j = -numberOfTicks; j <= numberOfTicks; ++j ) {
-        float tick = static_cast<float>( j ) / numberOfTicks;
+void initialiseCubic( cubicInterpolator &cubic, const int channels, const double inputRate, const double outputRate ) {
+    cubic.channels = channels;
+    cubic.step     = inputRate / outputRate;
+    cubic.inputs   = 0;
+    cubic.outputs  = 0;
+    cubic.history.assign( channels * 8, 0.0 );
+}
 
-        // x axis
-        axisTicks[i++] = { tick, tickSize * aspectRatio };
-        axisTicks[i++] = { tick, -tickSize * aspectRatio };
-        // y axis
-        axisTicks[i++] = { -tickSize, tick };
-        axisTicks[i++] = { tickSize, tick };
+void pushCubic( cubicInterpolator &cubic, const double *frame, std::vector<double> &output ) {
+    // adds one input frame and appends the outputs between the middle two of the last four, interleaved
+    // every output in the segment is the same cubic at its own fraction, so the inner loop has nothing carried and vectorises
+    const int index = static_cast<int>( cubic.inputs % 4 );
+    for( int channel = 0; channel < cubic.channels; channel++ ) {
+        double *history    = cubic.history.data() + channel * 8;
+        history[index]     = frame[channel];
+        history[index + 4] = frame[channel];
+    }
+    cubic.inputs += 1;
+    // frames before the first are zero, so the segment from frame 0 to 1 is ready once frame 2 is in
+    const long long segment = cubic.inputs - 3;
+    if( segment < 0 ) {
+        return;
+    }
+    const long long   count = std::max( 0LL, static_cast<long long>( std::ceil( ( segment + 1 ) / cubic.step ) ) - cubic.outputs );
+    const double      first = cubic.outputs * cubic.step - segment;
+    const std::size_t base  = output.size();
+    output.resize( base + count * cubic.channels );
+    for( int channel = 0; channel < cubic.channels; channel++ ) {
+        const double *y   = cubic.history.data() + channel * 8 + index + 1; // frames segment - 1 to segment + 2
+        const double  a   = y[1];
+        const double  b   = 0.5 * ( y[2] - y[0] );
+        const double  c   = y[0] - 2.5 * y[1] + 2.0 * y[2] - 0.5 * y[3];
+        const double  d   = 0.5 * ( y[3] - y[0] ) + 1.5 * ( y[1] - y[2] );
+        const double  dt  = cubic.step;
+        double       *out = output.data() + base + channel;
+        for( long long k = 0; k < count; k++ ) {
+            const double f          = first + k * dt;
+            out[k * cubic.channels] = a + f * ( b + f * ( c + f * d ) );
+        }
     }
+    cubic.outputs += count;
 }
 
-void pushToBuffer( std::queue<bufferData> &buffer, const std::vector<double> &stringVector, const double time ) {
-    // buffers the past 10 values passed into it
-    bufferData data;
-    data.string = stringVector;
-    data.time   = time;
-    buffer.push( data );
-    if( buffer.size() > 10 ) {
-        buffer.pop();
+bool initialiseDrive( boundaryDrive &drive, const scenario &run ) {
+    // reads up to the first frame to find how many columns there are, the reader thread parses the rest
+    drive.enabled  = !run.driveFile.empty() && ( run.driveFirst || run.driveLast );
+    drive.finished = true;
+    if( !drive.enabled ) {
+        return true;
     }
+    if( run.scheme == crankNicolsonScheme && run.boundary != fixedEnds ) {
+        drive.error   = "driven with crank nicolson, which needs boundary = fixed";
+        drive.enabled = false;
+        return false;
+    }
+    drive.file.open( run.driveFile );
+    if( !drive.file ) {
+        drive.error   = std::format( "could not open file, {}", run.driveFile );
+        drive.enabled = false;
+        return false;
+    }
+    std::vector<double> frame;
+    std::string         line;
+    while( frame.empty() && std::getline( drive.file, line ) ) {
+        const char *text = line.c_str();
+        char       *end  = nullptr;
+        for( double value = std::strtod( text, &end ); end != text; value = std::strtod( text, &end ) ) {
+            frame.push_back( value );
+            text = end;
+        }
+        if( frame.empty() && trim( line ) != "" && trim( line )[0] != '#' ) {
+            break;
+        }
+    }
+    const int drivenEnds = run.driveFirst + run.driveLast;
+    if( frame.empty() || ( frame.size() != 1 && static_cast<int>( frame.size() ) != drivenEnds ) ) {
+        drive.error   = std::format( "{} needs 1 or {} columns of numbers", run.driveFile, drivenEnds );
+        drive.enabled = false;
+        return false;
+    }
+    drive.driven[0]  = run.driveFirst;
+    drive.driven[1]  = run.driveLast;
+    drive.columns    = static_cast<int>( frame.size() );
+    drive.gain       = run.driveGain;
+    drive.sinc       = run.driveInterpolation == "sinc";
+    drive.finished   = false;
+    drive.stopping   = false;
+    drive.failed     = false;
+    drive.chunk      = frame;
+    drive.chunkFrame = 0;
+    drive.exhausted  = false;
+    drive.nextValue  = 0;
+    drive.values.clear();
+    if( drive.sinc ) {
+        initialiseResampler( drive.resampler, drive.columns, 1.0 / run.driveInterval, 1.0 / run.deltaTime );
+    }
+    else {
+        initialiseCubic( drive.cubic, drive.columns, 1.0 / run.driveInterval, 1.0 / run.deltaTime );
+    }
+    drive.reader = std::thread( readDrive, std::ref( drive ) );
+    return true;
 }
 
-void writeToFile( std::queue<bufferData> buffer, std::ofstream &data, const double deltaLength ) {
-    // saves the buffered data to the file
-    const int initialBufferSize = buffer.size();
-    for( int i = 0; i < initialBufferSize; i++ ) {
-        std::vector<double> stringVector = buffer.front().string;
-        double              time         = buffer.front().time;
-        for( int j = 0; j < stringVector.size(); j++ ) {
-            data << std::format( "{:.1f}\t{}\t{}\n", time, j * deltaLength, stringVector.at( j ) );
+void readDrive( boundaryDrive &drive ) {
+    // reader thread, parses whole chunks so the job only ever takes a lock once per driveChunkFrames frames
+    TRACE_THREAD( "drive reader" );
+    std::string         line;
+    std::vector<double> chunk;
+    bool                reading = true;
+    while( reading ) {
+        chunk.clear();
+        chunk.reserve( driveChunkFrames * drive.columns );
+        while( static_cast<int>( chunk.size() ) < driveChunkFrames * drive.columns ) {
+            if( !std::getline( drive.file, line ) ) {
+                reading = false;
+                break;
+            }
+            const char *text   = line.c_str();
+            char       *end    = nullptr;
+            int         values = 0;
+            for( double value = std::strtod( text, &end ); end != text && values < drive.columns; value = std::strtod( text, &end ) ) {
+                chunk.push_back( value );
+                values += 1;
+                text = end;
+            }
+            if( values != drive.columns ) {
+                chunk.resize( chunk.size() - values );
+                if( values != 0 || ( trim( line ) != "" && trim( line )[0] != '#' ) ) {
+                    std::lock_guard<std::mutex> lock( drive.mutex );
+                    drive.failed = true;
+                    reading      = false;
+                    break;
+                }
+            }
         }
-        buffer.pop();
+        std::unique_lock<std::mutex> lock( drive.mutex );
+        drive.condition.wait( lock, [&drive] { return static_cast<int>( drive.chunks.size() ) < driveReadAheadChunks || drive.stopping; } );
+        if( drive.stopping ) {
+            break;
+        }
+        if( !chunk.empty() ) {
+            drive.chunks.push( std::move( chunk ) );
+            chunk = std::vector<double>();
+        }
+        lock.unlock();
+        drive.condition.notify_all();
     }
-    std::cout << "Data Saved!" << std::endl;
+    {
+        std::lock_guard<std::mutex> lock( drive.mutex );
+        drive.finished = true;
+    }
+    drive.condition.notify_all();
 }
 
-void checkWaveSpeed( std::vector<double> &tension, std::vector<double> &mass, const double deltaTime, const double length, const int numberOfPoints ) {
-    double Va    = 0.0; // Alfven velocity
-    double VaMax = 0.0;
-    for( int i = 0; i < numberOfPoints; ++i ) {
-        if( mass[i] <= 0.0 ) {
-            std::cout << "Invalid mass" << std::endl;
+bool nextDriveFrame( boundaryDrive &drive, double *ends ) {
+    // where each end is at the next step, input frames are taken and interpolated only once the last lot is used up
+    while( drive.nextValue * drive.columns >= drive.values.size() ) {
+        drive.values.clear();
+        drive.nextValue = 0;
+        if( drive.chunkFrame * drive.columns >= drive.chunk.size() && !drive.exhausted ) {
+            TRACE_ZONE( "wait for drive" );
+            std::unique_lock<std::mutex> lock( drive.mutex );
+            drive.condition.wait( lock, [&drive] { return !drive.chunks.empty() || drive.finished; } );
+            if( drive.chunks.empty() ) {
+                if( drive.failed ) {
+                    drive.error = std::format( "drive file has a line without {} numbers on it", drive.columns );
+                    return false;
+                }
+                drive.exhausted = true;
+            }
+            else {
+                drive.chunk = std::move( drive.chunks.front() );
+                drive.chunks.pop();
+                drive.chunkFrame = 0;
+                lock.unlock();
+                drive.condition.notify_all();
+            }
         }
-        Va = std::sqrt( tension[i] / mass[i] );
-        if( Va > VaMax ) {
-            VaMax = Va;
+        // once the series has run out zeros are pushed, so the interpolators run back down to rest and stay there
+        const double  rest[2] = { 0.0, 0.0 };
+        const double *frame   = drive.exhausted ? rest : drive.chunk.data() + drive.chunkFrame * drive.columns;
+        if( drive.sinc ) {
+            pushResampler( drive.resampler, frame, drive.values );
+        }
+        else {
+            pushCubic( drive.cubic, frame, drive.values );
+        }
+        if( !drive.exhausted ) {
+            drive.chunkFrame += 1;
         }
     }
-    if( VaMax > ( ( length / ( numberOfPoints - 1 ) ) / deltaTime ) ) {
-        std::cout << "Delta time is too large" << std::endl;
+    const double *frame = drive.values.data() + drive.nextValue * drive.columns;
+    ends[0]             = frame[0] * drive.gain;
+    ends[1]             = frame[drive.columns - 1] * drive.gain;
+    drive.nextValue += 1;
+    return true;
+}
+
+template <typename real>
+void holdDrivenEnds( const boundaryDrive &drive, std::vector<real> &stringVector, std::vector<real> &velocity, const double *ends, const double *previousEnds, const double deltaTime ) {
+    // the driven ends are where the series puts them, moving at the rate it took them there
+    const int last = static_cast<int>( stringVector.size() ) - 1;
+    for( int end = 0; end < 2; end++ ) {
+        if( drive.driven[end] ) {
+            const int i     = end == 0 ? 0 : last;
+            stringVector[i] = static_cast<real>( ends[end] );
+            velocity[i]     = static_cast<real>( ( ends[end] - previousEnds[end] ) / deltaTime );
+        }
+    }
+}
+
+void closeDrive( boundaryDrive &drive ) {
+    // the reader may be waiting for room, so it is told to stop before it is joined
+    if( !drive.reader.joinable() ) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock( drive.mutex );
+        drive.stopping = true;
     }
+    drive.condition.notify_all();
+    drive.reader.join();
 }
 
 // opengl functions
 // ----------------
 
-void initialiseGLFW() {
+void initialiseGLFW( const bool offscreen ) {
+#ifdef GLFW_PLATFORM_NULL
+    // offscreen runs dont need a display, the context comes from osmesa so mesa's software rasteriser works anywhere
+    if( offscreen ) {
+        glfwInitHint( GLFW_PLATFORM, GLFW_PLATFORM_NULL );
+    }
+#else
+    // glfw before 3.4 has no null platform, the hidden window still needs a display
+    if( offscreen ) {
+        std::cout << "Note: glfw is older than 3.4 so offscreen runs still need a display, under xvfb-run for example" << std::endl;
+    }
+#endif
     // initialises glfw
     glfwInit();
     glfwWindowHint( GLFW_CONTEXT_VERSION_MAJOR, 3 );
@@ -611,6 +3848,14 @@ void initialiseGLFW() {
 #ifdef __APPLE__
     glfwWindowHint( GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE );
 #endif
+
+    // offscreen runs draw into a framebuffer object so the window is never shown
+    if( offscreen ) {
+        glfwWindowHint( GLFW_VISIBLE, GLFW_FALSE );
+#ifdef GLFW_PLATFORM_NULL
+        glfwWindowHint( GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API );
+#endif
+    }
 }
 
 void initialiseGLAD() {
@@ -626,13 +3871,13 @@ void initialiseGLAD() {
     glClearColor( 1.0f, 1.0f, 1.0f, 1.0f );
 }
 
-void initialiseShaders( unsigned int &vertexShader, unsigned int &fragmentShader, unsigned int &shaderProgram, int &colourLocation ) {
+void initialiseShaders( const char *vertexSource, const char *fragmentSource, unsigned int &vertexShader, unsigned int &fragmentShader, unsigned int &shaderProgram, int &colourLocation ) {
     // error logging
     int  success;
     char infolog[512];
     // vertex shader
     vertexShader = glCreateShader( GL_VERTEX_SHADER );
-    glShaderSource( vertexShader, 1, &vertexShaderSource, NULL );
+    glShaderSource( vertexShader, 1, &vertexSource, NULL );
     glCompileShader( vertexShader );
 
     glGetShaderiv( vertexShader, GL_COMPILE_STATUS, &success );
@@ -643,7 +3888,7 @@ void initialiseShaders( unsigned int &vertexShader, unsigned int &fragmentShader
 
     // fragment shader
     fragmentShader = glCreateShader( GL_FRAGMENT_SHADER );
-    glShaderSource( fragmentShader, 1, &fragmentShaderSource, NULL );
+    glShaderSource( fragmentShader, 1, &fragmentSource, NULL );
     glCompileShader( fragmentShader );
 
     glGetShaderiv( fragmentShader, GL_COMPILE_STATUS, &success );
@@ -670,19 +3915,148 @@ void initialiseShaders( unsigned int &vertexShader, unsigned int &fragmentShader
     colourLocation = glGetUniformLocation( shaderProgram, "colour" );
 }
 
-void initialiseVboVao( unsigned int &VBO, unsigned int &VAO, point *graph, unsigned int &shaderProgram ) {
+void initialiseVboVao( unsigned int &VBO, unsigned int &VAO, streamBuffer &stream, const int numberOfPoints, unsigned int &shaderProgram ) {
     // vbo
     glGenBuffers( 1, &VBO );
     glGenVertexArrays( 1, &VAO );
     glBindVertexArray( VAO );
-    // copy verticies array into a buffer
     glBindBuffer( GL_ARRAY_BUFFER, VBO );
-    glBufferData( GL_ARRAY_BUFFER, sizeof( graph ), graph, GL_STATIC_DRAW );
-    // set vertex attributes pointers
-    glVertexAttribPointer( 0, 2, GL_FLOAT, GL_FALSE, 0, (void *)0 );
+    // fixed size storage for every region, persistently mapped when the driver supports it
+    const GLsizeiptr      size          = streamRegions * numberOfPoints * sizeof( GLfloat );
+    const GLbitfield      flags         = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    bufferStorageFunction bufferStorage = NULL;
+    if( glfwExtensionSupported( "GL_ARB_buffer_storage" ) ) {
+        bufferStorage = reinterpret_cast<bufferStorageFunction>( glfwGetProcAddress( "glBufferStorage" ) );
+    }
+    stream.mapped = NULL;
+    if( bufferStorage != NULL ) {
+        bufferStorage( GL_ARRAY_BUFFER, size, NULL, flags );
+        stream.mapped = static_cast<GLfloat *>( glMapBufferRange( GL_ARRAY_BUFFER, 0, size, flags ) );
+        if( stream.mapped == NULL ) {
+            // immutable storage cant be respecified, so the fallback needs a fresh buffer
+            glDeleteBuffers( 1, &VBO );
+            glGenBuffers( 1, &VBO );
+            glBindBuffer( GL_ARRAY_BUFFER, VBO );
+        }
+    }
+    if( stream.mapped == NULL ) {
+        glBufferData( GL_ARRAY_BUFFER, size, NULL, GL_DYNAMIC_DRAW );
+        stream.staging.assign( numberOfPoints, 0.0f );
+    }
+    // stream state
+    for( int i = 0; i < streamRegions; i++ ) {
+        stream.fences[i] = NULL;
+    }
+    stream.region         = 0;
+    stream.drawRegion     = 0;
+    stream.numberOfPoints = numberOfPoints;
+    stream.VBO            = VBO;
+    // set vertex attributes pointers, only y is stored
+    glVertexAttribPointer( 0, 1, GL_FLOAT, GL_FALSE, 0, (void *)0 );
     glEnableVertexAttribArray( 0 );
 }
 
+GLfloat *beginStreamWrite( streamBuffer &stream ) {
+    // waits for the gpu to finish with the next region, it was last drawn two frames ago so this almost never blocks
+    GLsync &fence = stream.fences[stream.region];
+    if( fence != NULL ) {
+        glClientWaitSync( fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000 );
+        glDeleteSync( fence );
+        fence = NULL;
+    }
+    if( stream.mapped == NULL ) {
+        return stream.staging.data();
+    }
+    return stream.mapped + stream.region * stream.numberOfPoints;
+}
+
+void endStreamWrite( streamBuffer &stream ) {
+    TRACE_ZONE( "upload" );
+    // uploads the frame when the buffer isnt mapped and makes it the one to draw
+    if( stream.mapped == NULL ) {
+        glBindBuffer( GL_ARRAY_BUFFER, stream.VBO );
+        glBufferSubData( GL_ARRAY_BUFFER, stream.region * stream.numberOfPoints * sizeof( GLfloat ), stream.numberOfPoints * sizeof( GLfloat ), stream.staging.data() );
+    }
+    stream.drawRegion = stream.region;
+    stream.region     = ( stream.region + 1 ) % streamRegions;
+}
+
+void fenceStream( streamBuffer &stream ) {
+    // marks where in the command stream the gpu is done with the drawn region
+    GLsync &fence = stream.fences[stream.drawRegion];
+    if( fence != NULL ) {
+        glDeleteSync( fence );
+    }
+    fence = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+}
+
+void convertToFloat( const double *__restrict source, GLfloat *__restrict destination, const int count ) {
+    // plain loop over non aliasing pointers so the compiler turns it into packed double to float conversions
+    for( int i = 0; i < count; i++ ) {
+        destination[i] = static_cast<GLfloat>( source[i] );
+    }
+}
+
+void makeLevelOfDetail( levelOfDetail &lod, const int numberOfPoints, const int width ) {
+    // splits the string into one range per pixel column, only worth it with more than two points per pixel
+    lod.numberOfPoints = numberOfPoints;
+    lod.changed        = true;
+    if( width < 2 || numberOfPoints <= 2 * width ) {
+        lod.columns = 0;
+        lod.columnStart.clear();
+        return;
+    }
+    lod.columns = width;
+    lod.columnStart.resize( width + 1 );
+    for( int c = 0; c <= width; c++ ) {
+        lod.columnStart[c] = static_cast<int>( static_cast<long long>( c ) * ( numberOfPoints - 1 ) / width );
+    }
+}
+
+int buildEnvelope( levelOfDetail &lod, const double *__restrict source, GLfloat *__restrict destination ) {
+    // min and max of each column, neighbouring columns share their edge point so the envelope stays joined up
+    // a column whose points are the same as last time keeps its envelope, so a quiet stretch of string costs a compare rather than a rebuild
+    const int  lanes   = 4; // independent running min/max so the compiler can use packed min/max instructions
+    const bool rebuild = lod.changed || static_cast<int>( lod.previous.size() ) != lod.numberOfPoints;
+    if( rebuild ) {
+        lod.previous.assign( source, source + lod.numberOfPoints );
+        lod.envelope.resize( 2 * lod.columns );
+    }
+    for( int c = 0; c < lod.columns; c++ ) {
+        const int start = lod.columnStart[c];
+        const int end   = lod.columnStart[c + 1];
+        if( !rebuild ) {
+            double *previous = lod.previous.data() + start;
+            if( std::memcmp( source + start, previous, ( end - start + 1 ) * sizeof( double ) ) == 0 ) {
+                continue;
+            }
+            std::memcpy( previous, source + start, ( end - start + 1 ) * sizeof( double ) );
+        }
+        double    low[lanes];
+        double    high[lanes];
+        for( int j = 0; j < lanes; j++ ) {
+            low[j]  = source[start];
+            high[j] = source[start];
+        }
+        int i = start;
+        for( ; i + lanes <= end + 1; i += lanes ) {
+            for( int j = 0; j < lanes; j++ ) {
+                low[j]  = source[i + j] < low[j] ? source[i + j] : low[j];
+                high[j] = source[i + j] > high[j] ? source[i + j] : high[j];
+            }
+        }
+        for( ; i <= end; i++ ) {
+            low[0]  = std::min( low[0], source[i] );
+            high[0] = std::max( high[0], source[i] );
+        }
+        lod.envelope[2 * c]     = static_cast<GLfloat>( std::min( std::min( low[0], low[1] ), std::min( low[2], low[3] ) ) );
+        lod.envelope[2 * c + 1] = static_cast<GLfloat>( std::max( std::max( high[0], high[1] ), std::max( high[2], high[3] ) ) );
+    }
+    // the stream region is a different one each frame, so every column is copied whether it was rebuilt or not
+    std::copy( lod.envelope.begin(), lod.envelope.end(), destination );
+    return 2 * lod.columns;
+}
+
 void initialiseAxesVboVao( unsigned int &axesVBO, unsigned int &axesVAO, point *axes, unsigned int &shaderProgram ) {
     // vbo
     glGenBuffers( 1, &axesVBO );
@@ -709,10 +4083,21 @@ void initialiseAxisTicksVboVao( unsigned int &axisTicksVBO, unsigned int &axisTi
     glEnableVertexAttribArray( 0 );
 }
 
-void processInput( GLFWwindow *window, float &updateSpeed, bool &saveData ) {
+void processInput( GLFWwindow *window, float &updateSpeed, bool &saveData, bool &showWaterfall, bool &showHud, fieldLineView &view, const double frameTime ) {
+    TRACE_ZONE( "processInput" );
     // saving data variables
     static bool saveKeyWasPressed = false;
     bool        saveKeyIsPressed  = glfwGetKey( window, GLFW_KEY_0 ) == GLFW_PRESS;
+    // waterfall toggle variables
+    static bool waterfallKeyWasPressed = false;
+    bool        waterfallKeyIsPressed  = glfwGetKey( window, GLFW_KEY_W ) == GLFW_PRESS;
+    // performance hud toggle variables
+    static bool hudKeyWasPressed = false;
+    bool        hudKeyIsPressed  = glfwGetKey( window, GLFW_KEY_H ) == GLFW_PRESS;
+    // field line view variables
+    static bool viewKeyWasPressed = false;
+    bool        viewKeyIsPressed  = glfwGetKey( window, GLFW_KEY_V ) == GLFW_PRESS;
+    const float turnSpeed         = 1.5f; // camera turn speed (radians/seccond)
     // key presses
     if( glfwGetKey( window, GLFW_KEY_ESCAPE ) == GLFW_PRESS ) {
         glfwSetWindowShouldClose( window, true );
@@ -736,9 +4121,505 @@ void processInput( GLFWwindow *window, float &updateSpeed, bool &saveData ) {
         saveData = true;
     }
     saveKeyWasPressed = saveKeyIsPressed;
+    if( waterfallKeyIsPressed && !waterfallKeyWasPressed ) {
+        showWaterfall = !showWaterfall;
+    }
+    waterfallKeyWasPressed = waterfallKeyIsPressed;
+    if( hudKeyIsPressed && !hudKeyWasPressed ) {
+        showHud = !showHud;
+    }
+    hudKeyWasPressed = hudKeyIsPressed;
+    if( viewKeyIsPressed && !viewKeyWasPressed ) {
+        view.show = !view.show;
+    }
+    viewKeyWasPressed = viewKeyIsPressed;
+    // orbiting the field line view
+    if( glfwGetKey( window, GLFW_KEY_LEFT ) == GLFW_PRESS ) {
+        view.yaw -= turnSpeed * frameTime;
+    }
+    if( glfwGetKey( window, GLFW_KEY_RIGHT ) == GLFW_PRESS ) {
+        view.yaw += turnSpeed * frameTime;
+    }
+    if( glfwGetKey( window, GLFW_KEY_UP ) == GLFW_PRESS ) {
+        view.pitch = std::min( view.pitch + turnSpeed * static_cast<float>( frameTime ), 1.5f );
+    }
+    if( glfwGetKey( window, GLFW_KEY_DOWN ) == GLFW_PRESS ) {
+        view.pitch = std::max( view.pitch - turnSpeed * static_cast<float>( frameTime ), -1.5f );
+    }
+}
+
+bool processHistoryInput( GLFWwindow *window, historyPlayback &playback, const float updateSpeed, const double frameTime, const double earliestTime, const double latestTime ) {
+    // r switches between the live string and the history, [ and ] play it backwards and forwards at the update speed,
+    // space pauses and , and . step a frame at a time, returns true when r switched
+    static bool historyKeyWasPressed = false;
+    static bool backKeyWasPressed    = false;
+    static bool forwardKeyWasPressed = false;
+    bool        historyKeyIsPressed  = glfwGetKey( window, GLFW_KEY_R ) == GLFW_PRESS;
+    bool        backKeyIsPressed     = glfwGetKey( window, GLFW_KEY_COMMA ) == GLFW_PRESS;
+    bool        forwardKeyIsPressed  = glfwGetKey( window, GLFW_KEY_PERIOD ) == GLFW_PRESS;
+    bool        switched             = historyKeyIsPressed && !historyKeyWasPressed;
+    if( switched ) {
+        playback.active   = !playback.active;
+        playback.position = latestTime;
+        playback.rate     = 0.0;
+    }
+    historyKeyWasPressed = historyKeyIsPressed;
+    if( playback.active ) {
+        if( glfwGetKey( window, GLFW_KEY_LEFT_BRACKET ) == GLFW_PRESS ) {
+            playback.rate = -updateSpeed;
+        }
+        if( glfwGetKey( window, GLFW_KEY_RIGHT_BRACKET ) == GLFW_PRESS ) {
+            playback.rate = updateSpeed;
+        }
+        if( glfwGetKey( window, GLFW_KEY_SPACE ) == GLFW_PRESS ) {
+            playback.rate = 0.0;
+        }
+        // the number keys change the speed while playing
+        if( playback.rate != 0.0 ) {
+            playback.rate = std::copysign( static_cast<double>( updateSpeed ), playback.rate );
+        }
+        if( backKeyIsPressed && !backKeyWasPressed ) {
+            playback.rate = 0.0;
+            playback.position -= historyInterval;
+        }
+        if( forwardKeyIsPressed && !forwardKeyWasPressed ) {
+            playback.rate = 0.0;
+            playback.position += historyInterval;
+        }
+        playback.position = std::clamp( playback.position + playback.rate * frameTime, earliestTime, latestTime );
+    }
+    backKeyWasPressed    = backKeyIsPressed;
+    forwardKeyWasPressed = forwardKeyIsPressed;
+    return switched;
+}
+
+void initialiseFrameCapture( frameCapture &capture, const int width, const int height ) {
+    // framebuffer with a single colour attachment that the scene is drawn into instead of the window
+    capture.width  = width;
+    capture.height = height;
+    glGenFramebuffers( 1, &capture.FBO );
+    glGenRenderbuffers( 1, &capture.colourRBO );
+    glBindRenderbuffer( GL_RENDERBUFFER, capture.colourRBO );
+    glRenderbufferStorage( GL_RENDERBUFFER, GL_RGBA8, width, height );
+    glBindFramebuffer( GL_FRAMEBUFFER, capture.FBO );
+    glFramebufferRenderbuffer( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, capture.colourRBO );
+    // depth for the 3d field line view
+    glGenRenderbuffers( 1, &capture.depthRBO );
+    glBindRenderbuffer( GL_RENDERBUFFER, capture.depthRBO );
+    glRenderbufferStorage( GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height );
+    glFramebufferRenderbuffer( GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, capture.depthRBO );
+    if( glCheckFramebufferStatus( GL_FRAMEBUFFER ) != GL_FRAMEBUFFER_COMPLETE ) {
+        std::cout << "ERROR::FRAMEBUFFER::NOT_COMPLETE" << std::endl;
+    }
+    glViewport( 0, 0, width, height );
+    // pixel buffers the frames are read back into
+    glGenBuffers( captureRegions, capture.PBOs );
+    for( int i = 0; i < captureRegions; i++ ) {
+        glBindBuffer( GL_PIXEL_PACK_BUFFER, capture.PBOs[i] );
+        glBufferData( GL_PIXEL_PACK_BUFFER, width * height * 4, NULL, GL_STREAM_READ );
+        capture.fences[i] = NULL;
+    }
+    glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+    capture.next    = 0;
+    capture.pending = 0;
+}
+
+void captureFrame( frameCapture &capture, frameWriter &writer ) {
+    TRACE_ZONE( "captureFrame" );
+    // starts reading the frame just drawn into the next pixel buffer, the copy happens on the gpu's own time
+    glBindFramebuffer( GL_READ_FRAMEBUFFER, capture.FBO );
+    glBindBuffer( GL_PIXEL_PACK_BUFFER, capture.PBOs[capture.next] );
+    glReadPixels( 0, 0, capture.width, capture.height, GL_RGBA, GL_UNSIGNED_BYTE, (void *)0 );
+    glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+    capture.fences[capture.next] = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+    capture.next                 = ( capture.next + 1 ) % captureRegions;
+    capture.pending += 1;
+    // once the ring is full the oldest read has had a couple of frames to finish
+    if( capture.pending == captureRegions ) {
+        collectFrame( capture, writer );
+    }
+}
+
+void collectFrame( frameCapture &capture, frameWriter &writer ) {
+    // maps the oldest pixel buffer and hands a copy of it to the writer thread
+    const int        oldest = ( capture.next - capture.pending + captureRegions ) % captureRegions;
+    const GLsizeiptr size   = capture.width * capture.height * 4;
+    glClientWaitSync( capture.fences[oldest], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000 );
+    glDeleteSync( capture.fences[oldest] );
+    capture.fences[oldest] = NULL;
+    glBindBuffer( GL_PIXEL_PACK_BUFFER, capture.PBOs[oldest] );
+    const unsigned char *pixels = static_cast<const unsigned char *>( glMapBufferRange( GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT ) );
+    if( pixels != NULL ) {
+        queueFrame( writer, std::vector<unsigned char>( pixels, pixels + size ) );
+        glUnmapBuffer( GL_PIXEL_PACK_BUFFER );
+    }
+    glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+    capture.pending -= 1;
+}
+
+void finishFrameCapture( frameCapture &capture, frameWriter &writer ) {
+    // collects the frames still in flight then lets the writer thread run dry
+    while( capture.pending > 0 ) {
+        collectFrame( capture, writer );
+    }
+    {
+        std::lock_guard<std::mutex> lock( writer.mutex );
+        writer.finished = true;
+    }
+    writer.condition.notify_all();
+}
+
+void queueFrame( frameWriter &writer, std::vector<unsigned char> &&pixels ) {
+    // waits if the writer has fallen too far behind so memory use stays bounded
+    std::unique_lock<std::mutex> lock( writer.mutex );
+    writer.condition.wait( lock, [&writer] { return writer.frames.size() < 16; } );
+    writer.frames.push( std::move( pixels ) );
+    lock.unlock();
+    writer.condition.notify_all();
+}
+
+void writeFrames( frameWriter &writer ) {
+    // writer thread, saves each frame as a binary ppm, turn them into a video with
+    // ffmpeg -framerate 30 -i frame_%06d.ppm -pix_fmt yuv420p video.mp4
+    std::vector<unsigned char> row( writer.width * 3 );
+    TRACE_THREAD( "frame writer" );
+    while( true ) {
+        std::vector<unsigned char> pixels;
+        {
+            std::unique_lock<std::mutex> lock( writer.mutex );
+            writer.condition.wait( lock, [&writer] { return !writer.frames.empty() || writer.finished; } );
+            if( writer.frames.empty() ) {
+                return;
+            }
+            pixels = std::move( writer.frames.front() );
+            writer.frames.pop();
+        }
+        writer.condition.notify_all();
+
+        TRACE_ZONE( "write frame" );
+        std::string   fileName = std::format( "{}/frame_{:06d}.ppm", writer.directory, writer.written );
+        std::ofstream image( fileName, std::ios::binary );
+        if( !image ) {
+            std::cerr << std::format( "Error: could not open file, {}\n\n", fileName );
+            continue;
+        }
+        image << std::format( "P6\n{} {}\n255\n", writer.width, writer.height );
+        // opengl rows start at the bottom, ppm rows start at the top
+        for( int y = writer.height - 1; y >= 0; y-- ) {
+            const unsigned char *source = pixels.data() + y * writer.width * 4;
+            for( int x = 0; x < writer.width; x++ ) {
+                row[3 * x]     = source[4 * x];
+                row[3 * x + 1] = source[4 * x + 1];
+                row[3 * x + 2] = source[4 * x + 2];
+            }
+            image.write( reinterpret_cast<const char *>( row.data() ), row.size() );
+        }
+        writer.written += 1;
+    }
+}
+
+void initialiseWaterfall( waterfallData &waterfall, const int numberOfPoints, const int rows, const double interval ) {
+    // ring of rows in a float texture, one row per captured string
+    waterfall.columns   = std::min( numberOfPoints, waterfallMaxColumns );
+    waterfall.rows      = rows;
+    waterfall.newestRow = rows - 1;
+    waterfall.interval  = interval;
+    waterfall.nextTime  = 0.0;
+    waterfall.amplitude = 0.0f;
+    waterfall.row.assign( waterfall.columns, 0.0f );
+    std::vector<GLfloat> empty( waterfall.columns * rows, 0.0f );
+    glGenTextures( 1, &waterfall.texture );
+    glBindTexture( GL_TEXTURE_2D, waterfall.texture );
+    glTexImage2D( GL_TEXTURE_2D, 0, GL_R32F, waterfall.columns, rows, 0, GL_RED, GL_FLOAT, empty.data() );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST ); // nearest so the newest and oldest rows dont blend at the seam
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT );
+    // full screen quad, the viewport decides where it ends up
+    // clang-format off
+    point quad[4] = {
+        {-1.0f, -1.0f},
+        { 1.0f, -1.0f},
+        {-1.0f,  1.0f},
+        { 1.0f,  1.0f}
+    };
+    // clang-format on
+    glGenBuffers( 1, &waterfall.VBO );
+    glGenVertexArrays( 1, &waterfall.VAO );
+    glBindVertexArray( waterfall.VAO );
+    glBindBuffer( GL_ARRAY_BUFFER, waterfall.VBO );
+    glBufferData( GL_ARRAY_BUFFER, 4 * sizeof( point ), quad, GL_STATIC_DRAW );
+    glVertexAttribPointer( 0, 2, GL_FLOAT, GL_FALSE, 0, (void *)0 );
+    glEnableVertexAttribArray( 0 );
+    // shader
+    unsigned int vertexShader;
+    unsigned int fragmentShader;
+    int          colourLocation;
+    initialiseShaders( waterfallVertexShaderSource, waterfallFragmentShaderSource, vertexShader, fragmentShader, waterfall.shaderProgram, colourLocation );
+    waterfall.newestRowLocation = glGetUniformLocation( waterfall.shaderProgram, "newestRow" );
+    waterfall.rowsLocation      = glGetUniformLocation( waterfall.shaderProgram, "rows" );
+    waterfall.amplitudeLocation = glGetUniformLocation( waterfall.shaderProgram, "amplitude" );
+}
+
+bool pushWaterfallRow( waterfallData &waterfall, const std::vector<double> &stringVector, const double time ) {
+    // captures the string once every interval, only one row is uploaded per capture
+    if( time + 1e-4 < waterfall.nextTime ) {
+        return false;
+    }
+    waterfall.nextTime = time + waterfall.interval;
+    const int numberOfPoints = stringVector.size();
+    for( int i = 0; i < waterfall.columns; i++ ) {
+        int index        = static_cast<int>( static_cast<long long>( i ) * ( numberOfPoints - 1 ) / std::max( waterfall.columns - 1, 1 ) );
+        waterfall.row[i] = static_cast<GLfloat>( stringVector[index] );
+        // colour scale follows the largest displacement seen so far
+        waterfall.amplitude = std::max( waterfall.amplitude, std::abs( waterfall.row[i] ) );
+    }
+    waterfall.newestRow = ( waterfall.newestRow + 1 ) % waterfall.rows;
+    glBindTexture( GL_TEXTURE_2D, waterfall.texture );
+    glTexSubImage2D( GL_TEXTURE_2D, 0, 0, waterfall.newestRow, waterfall.columns, 1, GL_RED, GL_FLOAT, waterfall.row.data() );
+    return true;
+}
+
+void renderWaterfall( waterfallData &waterfall ) {
+    TRACE_ZONE( "renderWaterfall" );
+    // draws the history with the newest row at the top
+    glUseProgram( waterfall.shaderProgram );
+    glUniform1f( waterfall.newestRowLocation, static_cast<float>( waterfall.newestRow ) );
+    glUniform1f( waterfall.rowsLocation, static_cast<float>( waterfall.rows ) );
+    glUniform1f( waterfall.amplitudeLocation, waterfall.amplitude > 0.0f ? waterfall.amplitude : 1.0f );
+    glActiveTexture( GL_TEXTURE0 );
+    glBindTexture( GL_TEXTURE_2D, waterfall.texture );
+    glBindVertexArray( waterfall.VAO );
+    glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+}
+
+void initialiseFieldLineView( fieldLineView &view, const std::vector<vec3> &worldPoints, const int numberOfPoints, const int numberOfLines, const int displacedLines ) {
+    view.show           = false;
+    view.yaw            = 0.0f;
+    view.pitch          = 0.3f;
+    view.amplitude      = 0.0f;
+    view.numberOfPoints = numberOfPoints;
+    view.numberOfLines  = numberOfLines;
+    view.displacedLines = displacedLines;
+    view.newestRow      = 0;
+    view.displacement.assign( numberOfPoints * displacedLines, 0.0f );
+
+    // base positions of the field line in earth radii, every line in the bundle is this rotated about the dipole axis
+    std::vector<GLfloat> base( 3 * numberOfPoints );
+    double               largestRadius = 1.0;
+    for( int i = 0; i < numberOfPoints; i++ ) {
+        base[3 * i]     = static_cast<GLfloat>( worldPoints[i].x / radiusEarth );
+        base[3 * i + 1] = static_cast<GLfloat>( worldPoints[i].y / radiusEarth );
+        base[3 * i + 2] = static_cast<GLfloat>( worldPoints[i].z / radiusEarth );
+        largestRadius   = std::max( largestRadius, std::sqrt( worldPoints[i].x * worldPoints[i].x + worldPoints[i].y * worldPoints[i].y + worldPoints[i].z * worldPoints[i].z ) / radiusEarth );
+    }
+    view.zoom = static_cast<float>( 0.9 / largestRadius );
+    glGenBuffers( 1, &view.baseVBO );
+    glGenVertexArrays( 1, &view.lineVAO );
+    glBindVertexArray( view.lineVAO );
+    glBindBuffer( GL_ARRAY_BUFFER, view.baseVBO );
+    glBufferData( GL_ARRAY_BUFFER, base.size() * sizeof( GLfloat ), base.data(), GL_STATIC_DRAW );
+    glVertexAttribPointer( 0, 3, GL_FLOAT, GL_FALSE, 0, (void *)0 );
+    glEnableVertexAttribArray( 0 );
+
+    // displacement of each distinct line, read in the vertex shader through a buffer texture
+    glGenBuffers( 1, &view.displacementBuffer );
+    glBindBuffer( GL_TEXTURE_BUFFER, view.displacementBuffer );
+    glBufferData( GL_TEXTURE_BUFFER, view.displacement.size() * sizeof( GLfloat ), view.displacement.data(), GL_STREAM_DRAW );
+    glGenTextures( 1, &view.displacementTexture );
+    glBindTexture( GL_TEXTURE_BUFFER, view.displacementTexture );
+    glTexBuffer( GL_TEXTURE_BUFFER, GL_R32F, view.displacementBuffer );
+    glBindBuffer( GL_TEXTURE_BUFFER, 0 );
+
+    // earth, a latitude/longitude sphere of radius one
+    const int            stacks = 16;
+    const int            slices = 32;
+    std::vector<GLfloat> sphere;
+    std::vector<GLuint>  indices;
+    for( int i = 0; i <= stacks; i++ ) {
+        double theta = std::numbers::pi * i / stacks;
+        for( int j = 0; j <= slices; j++ ) {
+            double phi = 2.0 * std::numbers::pi * j / slices;
+            sphere.push_back( static_cast<GLfloat>( std::sin( theta ) * std::cos( phi ) ) );
+            sphere.push_back( static_cast<GLfloat>( std::sin( theta ) * std::sin( phi ) ) );
+            sphere.push_back( static_cast<GLfloat>( std::cos( theta ) ) );
+        }
+    }
+    for( int i = 0; i < stacks; i++ ) {
+        for( int j = 0; j < slices; j++ ) {
+            GLuint first  = i * ( slices + 1 ) + j;
+            GLuint second = first + slices + 1;
+            indices.insert( indices.end(), { first, second, first + 1, second, second + 1, first + 1 } );
+        }
+    }
+    view.sphereIndices = indices.size();
+    glGenBuffers( 1, &view.sphereVBO );
+    glGenBuffers( 1, &view.sphereEBO );
+    glGenVertexArrays( 1, &view.sphereVAO );
+    glBindVertexArray( view.sphereVAO );
+    glBindBuffer( GL_ARRAY_BUFFER, view.sphereVBO );
+    glBufferData( GL_ARRAY_BUFFER, sphere.size() * sizeof( GLfloat ), sphere.data(), GL_STATIC_DRAW );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, view.sphereEBO );
+    glBufferData( GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof( GLuint ), indices.data(), GL_STATIC_DRAW );
+    glVertexAttribPointer( 0, 3, GL_FLOAT, GL_FALSE, 0, (void *)0 );
+    glEnableVertexAttribArray( 0 );
+
+    // shaders
+    unsigned int vertexShader;
+    unsigned int fragmentShader;
+    initialiseShaders( fieldLineVertexShaderSource, fragmentShaderSource, vertexShader, fragmentShader, view.lineShaderProgram, view.lineColourLocation );
+    initialiseShaders( sphereVertexShaderSource, sphereFragmentShaderSource, vertexShader, fragmentShader, view.sphereShaderProgram, view.sphereColourLocation );
+    glUseProgram( view.lineShaderProgram );
+    glUniform1i( glGetUniformLocation( view.lineShaderProgram, "numberOfPoints" ), numberOfPoints );
+    glUniform1i( glGetUniformLocation( view.lineShaderProgram, "numberOfLines" ), numberOfLines );
+    glUniform1i( glGetUniformLocation( view.lineShaderProgram, "displacedLines" ), displacedLines );
+    glUniform1f( glGetUniformLocation( view.lineShaderProgram, "azimuthalMode" ), static_cast<float>( fieldLineAzimuthalMode ) );
+    view.exaggerationLocation = glGetUniformLocation( view.lineShaderProgram, "exaggeration" );
+    view.newestRowLocation    = glGetUniformLocation( view.lineShaderProgram, "newestRow" );
+    view.lineRotationLocation = glGetUniformLocation( view.lineShaderProgram, "rotation" );
+    view.lineScaleLocation    = glGetUniformLocation( view.lineShaderProgram, "scale" );
+    view.sphereRotationLocation = glGetUniformLocation( view.sphereShaderProgram, "rotation" );
+    view.sphereScaleLocation    = glGetUniformLocation( view.sphereShaderProgram, "scale" );
+}
+
+void updateFieldLineView( fieldLineView &view, const double *stringVector ) {
+    // streams the displacement of the simulated line over the oldest row, only that row is uploaded
+    // with one row the shader spreads it across the bundle, with more each line round the bundle is one shown string older
+    view.newestRow = ( view.newestRow + 1 ) % view.displacedLines;
+    GLfloat *row   = view.displacement.data() + view.newestRow * view.numberOfPoints;
+    convertToFloat( stringVector, row, view.numberOfPoints );
+    for( int i = 0; i < view.numberOfPoints; i++ ) {
+        view.amplitude = std::max( view.amplitude, std::abs( row[i] ) );
+    }
+    glBindBuffer( GL_TEXTURE_BUFFER, view.displacementBuffer );
+    glBufferSubData( GL_TEXTURE_BUFFER, view.newestRow * view.numberOfPoints * sizeof( GLfloat ), view.numberOfPoints * sizeof( GLfloat ), row );
+    glBindBuffer( GL_TEXTURE_BUFFER, 0 );
+}
+
+void renderFieldLineView( fieldLineView &view, const int width, const int height ) {
+    TRACE_ZONE( "renderFieldLineView" );
+    // camera orbits the dipole axis, screen x and y are the rotated x and z with y going into the screen
+    const float cy          = std::cos( view.yaw );
+    const float sy          = std::sin( view.yaw );
+    const float cp          = std::cos( view.pitch );
+    const float sp          = std::sin( view.pitch );
+    const float aspectRatio = static_cast<float>( width ) / static_cast<float>( std::max( height, 1 ) );
+    // clang-format off
+    const GLfloat rotation[9] = {
+        cy,       sy * cp, sy * sp,
+        -sy,      cy * cp, cy * sp,
+        0.0f,     -sp,     cp
+    };
+    // clang-format on
+    glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+    glEnable( GL_DEPTH_TEST );
+    // earth
+    glUseProgram( view.sphereShaderProgram );
+    glUniformMatrix3fv( view.sphereRotationLocation, 1, GL_FALSE, rotation );
+    glUniform2f( view.sphereScaleLocation, view.zoom / aspectRatio, view.zoom );
+    glUniform3f( view.sphereColourLocation, 0.35f, 0.55f, 0.85f );
+    glBindVertexArray( view.sphereVAO );
+    glDrawElements( GL_TRIANGLES, view.sphereIndices, GL_UNSIGNED_INT, (void *)0 );
+    // every line in the bundle in one instanced draw, the largest displacement is shown as half an earth radius
+    glUseProgram( view.lineShaderProgram );
+    glUniformMatrix3fv( view.lineRotationLocation, 1, GL_FALSE, rotation );
+    glUniform2f( view.lineScaleLocation, view.zoom / aspectRatio, view.zoom );
+    glUniform1f( view.exaggerationLocation, view.amplitude > 0.0f ? 0.5f / view.amplitude : 0.0f );
+    glUniform1i( view.newestRowLocation, view.newestRow );
+    glUniform3f( view.lineColourLocation, 0.0f, 0.0f, 0.0f );
+    glActiveTexture( GL_TEXTURE0 );
+    glBindTexture( GL_TEXTURE_BUFFER, view.displacementTexture );
+    glLineWidth( 1.3f );
+    glBindVertexArray( view.lineVAO );
+    glDrawArraysInstanced( GL_LINE_STRIP, 0, view.numberOfPoints, view.numberOfLines );
+    glDisable( GL_DEPTH_TEST );
+}
+
+void initialiseHud( performanceHud &hud, std::ofstream &counters ) {
+    hud.frameTimes.assign( hudHistory, 0.0f );
+    hud.nextFrame        = 0;
+    hud.frames           = 0;
+    hud.bytesUploaded    = 0;
+    hud.reportBytes      = 0;
+    hud.reportFrames     = 0;
+    hud.reportSteps      = 0;
+    hud.reportSolvedTime = 0.0;
+    hud.reportTime       = glfwGetTime();
+    hud.counters         = &counters;
+    hud.show             = false;
+    hud.graph.assign( hudHistory + 2, { 0.0f, 0.0f } ); // frame times then the 60 fps reference line
+    *hud.counters << "wallTime\tframeP50\tframeP95\tframeP99\tstepsPerSecond\tsimulatedPerWall\tlag\tbytesPerFrame\tbufferedFrames\twriterQueue\n";
+    // vbo
+    glGenBuffers( 1, &hud.VBO );
+    glGenVertexArrays( 1, &hud.VAO );
+    glBindVertexArray( hud.VAO );
+    glBindBuffer( GL_ARRAY_BUFFER, hud.VBO );
+    glBufferData( GL_ARRAY_BUFFER, hud.graph.size() * sizeof( point ), hud.graph.data(), GL_DYNAMIC_DRAW );
+    glVertexAttribPointer( 0, 2, GL_FLOAT, GL_FALSE, 0, (void *)0 );
+    glEnableVertexAttribArray( 0 );
+}
+
+void recordFrame( performanceHud &hud, const double frameTime ) {
+    // only plain adds and a store every frame, everything else waits for the report
+    hud.frameTimes[hud.nextFrame] = static_cast<float>( frameTime );
+    hud.nextFrame                 = ( hud.nextFrame + 1 ) % hudHistory;
+    hud.frames                    = std::min( hud.frames + 1, hudHistory );
+    hud.reportBytes += hud.bytesUploaded;
+    hud.bytesUploaded = 0;
+    hud.reportFrames += 1;
+}
+
+std::string reportCounters( performanceHud &hud, const solverCounters &counters, const double currentTime, const double lag, const int writerQueue ) {
+    // aggregates everything since the last report, writes a line to the counter stream and returns the hud summary
+    std::vector<float> sorted( hud.frameTimes.begin(), hud.frameTimes.begin() + hud.frames );
+    float              percentiles[3] = { 0.0f, 0.0f, 0.0f };
+    const double       fractions[3]   = { 0.50, 0.95, 0.99 };
+    for( int i = 0; i < 3 && !sorted.empty(); i++ ) {
+        auto nth = sorted.begin() + static_cast<int>( fractions[i] * ( sorted.size() - 1 ) );
+        std::nth_element( sorted.begin(), nth, sorted.end() );
+        percentiles[i] = *nth;
+    }
+    const long long steps          = counters.steps.load( std::memory_order_relaxed );
+    const double    solvedTime     = counters.solvedTime.load( std::memory_order_relaxed );
+    const int       bufferedFrames = counters.bufferedFrames.load( std::memory_order_relaxed );
+    const double    wallTime       = std::max( currentTime - hud.reportTime, 1e-9 );
+    const double    stepsPerSecond = ( steps - hud.reportSteps ) / wallTime;
+    const double    simulatedRatio = ( solvedTime - hud.reportSolvedTime ) / wallTime;
+    const double    bytesPerFrame  = hud.reportFrames > 0 ? static_cast<double>( hud.reportBytes ) / hud.reportFrames : 0.0;
+    *hud.counters << std::format( "{:.3f}\t{:.3f}\t{:.3f}\t{:.3f}\t{:.0f}\t{:.3f}\t{:.3f}\t{:.0f}\t{}\t{}\n", currentTime, 1000.0 * percentiles[0], 1000.0 * percentiles[1], 1000.0 * percentiles[2], stepsPerSecond, simulatedRatio, lag, bytesPerFrame, bufferedFrames, writerQueue );
+    hud.reportTime       = currentTime;
+    hud.reportSteps      = steps;
+    hud.reportSolvedTime = solvedTime;
+    hud.reportBytes      = 0;
+    hud.reportFrames     = 0;
+    return std::format( "frame p50/p95/p99 {:.1f}/{:.1f}/{:.1f}ms, {:.2e} steps/s, {:.2f} sim s/s, lag {:.2f}s, {:.1f} KB/frame, buffer {}/10, queue {}", 1000.0 * percentiles[0], 1000.0 * percentiles[1], 1000.0 * percentiles[2], stepsPerSecond, simulatedRatio, lag, bytesPerFrame / 1e3, bufferedFrames, writerQueue );
+}
+
+void renderHud( performanceHud &hud, unsigned int &shaderProgram, int colourLocation, const int width, const int height ) {
+    TRACE_ZONE( "renderHud" );
+    // frame time graph in the top left corner, the full height is 2 frames at 60 fps
+    const float fullScale = 2.0f / 60.0f;
+    for( int i = 0; i < hudHistory; i++ ) {
+        float frameTime = hud.frameTimes[( hud.nextFrame + i ) % hudHistory]; // oldest first
+        hud.graph[i]    = { 2.0f * i / ( hudHistory - 1 ) - 1.0f, std::min( frameTime / fullScale, 1.0f ) * 2.0f - 1.0f };
+    }
+    hud.graph[hudHistory]     = { -1.0f, 0.0f };
+    hud.graph[hudHistory + 1] = { 1.0f, 0.0f };
+    glViewport( 0, height - height / 4, width / 3, height / 4 );
+    glUseProgram( shaderProgram );
+    glBindBuffer( GL_ARRAY_BUFFER, hud.VBO );
+    glBufferSubData( GL_ARRAY_BUFFER, 0, hud.graph.size() * sizeof( point ), hud.graph.data() );
+    glBindVertexArray( hud.VAO );
+    glLineWidth( 1.0f );
+    glUniform3f( colourLocation, 0.6f, 0.6f, 0.6f );
+    glDrawArrays( GL_LINES, hudHistory, 2 );
+    glUniform3f( colourLocation, 0.8f, 0.1f, 0.1f );
+    glDrawArrays( GL_LINE_STRIP, 0, hudHistory );
+    glViewport( 0, 0, width, height );
 }
 
-void rendering( unsigned int &shaderProgram, unsigned int &VAO, unsigned int &axesVAO, unsigned int &axisTicksVAO, const int numberOfPoints, int colourLocation, const int numberOfticks ) {
+void rendering( unsigned int &shaderProgram, unsigned int &stringShaderProgram, unsigned int &VAO, unsigned int &axesVAO, unsigned int &axisTicksVAO, const int firstPoint, const int numberOfVertices, const int verticesPerPoint, int colourLocation, int stringColourLocation, int firstPointLocation, int pointsLocation, int verticesPerPointLocation, const int numberOfticks ) {
+    TRACE_ZONE( "rendering" );
     glClear( GL_COLOR_BUFFER_BIT );
     glUseProgram( shaderProgram );
     // axes
@@ -748,14 +4629,19 @@ void rendering( unsigned int &shaderProgram, unsigned int &VAO, unsigned int &ax
     glDrawArrays( GL_LINES, 0, 4 );
     glBindVertexArray( axisTicksVAO );
     glDrawArrays( GL_LINES, 0, numberOfticks );
-    // string
-    glUniform3f( colourLocation, 0.0f, 0.0f, 0.0f );
+    // string, x is generated in the shader from the vertex id
+    glUseProgram( stringShaderProgram );
+    glUniform3f( stringColourLocation, 0.0f, 0.0f, 0.0f );
+    glUniform1i( firstPointLocation, firstPoint );
+    glUniform1i( pointsLocation, numberOfVertices / verticesPerPoint );
+    glUniform1i( verticesPerPointLocation, verticesPerPoint );
     glLineWidth( 1.3f );
     glBindVertexArray( VAO );
-    glDrawArrays( GL_LINE_STRIP, 0, numberOfPoints );
+    glDrawArrays( GL_LINE_STRIP, firstPoint, numberOfVertices );
 }
 
 void eventSwap( GLFWwindow *window ) {
+    TRACE_ZONE( "eventSwap" );
     glfwSwapBuffers( window );
     glfwPollEvents();
 }
@@ -767,4 +4653,73 @@ void framebuffer_size_callback( GLFWwindow *window, int width, int height ) {
     makeAxisTicks( data->axisTicks, data->numberOfTicksOnAxis, 0.01f, window );
     glBindBuffer( GL_ARRAY_BUFFER, data->axisTicksVBO );
     glBufferData( GL_ARRAY_BUFFER, data->numberOfTicks * sizeof( point ), data->axisTicks, GL_STATIC_DRAW );
+    // rebuild the level of detail for the new width
+    makeLevelOfDetail( *data->lod, data->lod->numberOfPoints, width );
+}
+
+// tracing functions
+// -----------------
+
+#ifdef WAVES_TRACING
+traceZone::traceZone( const char *zoneName ) {
+    name  = zoneName;
+    start = traceNow();
 }
+
+traceZone::~traceZone() {
+    // the owning thread is the only writer, recorded is published last so saveTrace never sees a half written event
+    traceBuffer &buffer   = threadTraceBuffer();
+    long long    recorded = buffer.recorded.load( std::memory_order_relaxed );
+    buffer.events[recorded % traceCapacity] = { name, start, traceNow() - start };
+    buffer.recorded.store( recorded + 1, std::memory_order_release );
+}
+
+long long traceNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - traceStart ).count();
+}
+
+traceBuffer &threadTraceBuffer() {
+    // made the first time a thread records, never freed so the trace can still be saved after the thread ends
+    thread_local traceBuffer *buffer = NULL;
+    if( buffer == NULL ) {
+        buffer = new traceBuffer;
+        buffer->events.resize( traceCapacity );
+        buffer->recorded   = 0;
+        buffer->threadName = NULL;
+        std::lock_guard<std::mutex> lock( traceMutex );
+        buffer->threadId = traceBuffers.size();
+        traceBuffers.push_back( buffer );
+    }
+    return *buffer;
+}
+
+void nameTraceThread( const char *name ) {
+    threadTraceBuffer().threadName = name;
+}
+
+void saveTrace( const std::string &fileName ) {
+    // chrome trace event format, every zone is a complete event with times in microseconds
+    std::ofstream trace( fileName );
+    if( !trace ) {
+        std::cerr << std::format( "Error: could not open file, {}\n\n", fileName );
+        return;
+    }
+    std::lock_guard<std::mutex> lock( traceMutex );
+    trace << "{\"traceEvents\":[\n";
+    bool first = true;
+    for( traceBuffer *buffer : traceBuffers ) {
+        if( buffer->threadName != NULL ) {
+            trace << std::format( "{}{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}", first ? "" : ",\n", buffer->threadId, buffer->threadName );
+            first = false;
+        }
+        long long recorded = buffer->recorded.load( std::memory_order_acquire );
+        for( long long i = std::max( 0LL, recorded - traceCapacity ); i < recorded; i++ ) {
+            const traceEvent &event = buffer->events[i % traceCapacity];
+            trace << std::format( "{}{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}", first ? "" : ",\n", event.name, buffer->threadId, event.start / 1e3, event.duration / 1e3 );
+            first = false;
+        }
+    }
+    trace << "\n]}\n";
+    std::cout << std::format( "Saved trace to {}", fileName ) << std::endl;
+}
+#endif
@@ -6,6 +6,24 @@
 #include <fstream>
 #include <vector>
 #include <numbers>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+
+// structs
+struct outputBuffer // buffered writer, only hands whole blocks to the file
+{
+    std::ofstream    *file;
+    std::vector<char> data;
+    std::size_t       used;
+    std::size_t       bytesWritten;
+};
+
+// output settings
+const std::size_t outputBlockSize = 1 << 20; // size of each write to the file (bytes)
 
 // function prototypes
 std::vector<float> createString( const int numberOfPoints, const float length, const float height ); // plucked string
@@ -14,13 +32,23 @@ std::vector<float> createString( const int numberOfPoints, const float length, c
 
 std::vector<float> createString( const int numberOfPoints, const int mode, const float height ); // standing wave string
 
-void updateString( std::vector<float> &stringVector, std::ofstream &file, const float deltaLength );
+void updateString( std::vector<float> &stringVector, std::vector<float> &temporaryString, std::vector<float> &velocity, const std::vector<float> &mass, const float tension, const float deltaLength, const float deltaTime );
+
+void initialiseOutput( outputBuffer &output, std::ofstream &file, const bool binaryOutput, const int numberOfPoints, const float deltaLength );
+
+void writeFrame( outputBuffer &output, const std::vector<float> &stringVector, const float time, const float deltaLength, const bool binaryOutput );
+
+void appendBytes( outputBuffer &output, const void *bytes, const std::size_t size );
+
+void flushOutput( outputBuffer &output, const bool final );
 
 // main
 int main() {
     // file and data saving
-    std::string   fileName = "WavesOnStringsData.dat"; // name of file to save data to
-    std::ofstream data( "../../data/" + fileName );
+    const bool    binaryOutput   = true; // true = raw floats (.bin), false = tab separated text (.dat)
+    const int     outputInterval = 1;    // write a frame every n steps
+    std::string   fileName       = binaryOutput ? "WavesOnStringsData.bin" : "WavesOnStringsData.dat"; // name of file to save data to
+    std::ofstream data( "../../data/" + fileName, std::ios::binary );
     if( !data ) {
         std::cerr << format( "Error: could not open file, {}\n\n", fileName );
         abort();
@@ -29,13 +57,50 @@ int main() {
     const float length         = 100; // length of the string in the x direction (meters)
     const int   numberOfPoints = 101; // number of points in the string, can only be odd
     const float height         = 0.1;
+    const float deltaLength    = length / ( numberOfPoints - 1 );
     // testing
     // std::vector<float> stringVector = createString( numberOfPoints, length, height ); // 1
     // std::vector<float> stringVector = createString( numberOfPoints, 3, height ); // 3
     std::vector<float> stringVector = createString( numberOfPoints, length, height, 5, 50 ); // 2
-    updateString( stringVector, data, length / ( numberOfPoints - 1 ) );
+    // time
+    const float deltaTime = 0.1;  // delta time between steps (secconds)
+    float       time      = 0.0;  // time (secconds)
+    const float timeLimit = 50.0; // maximum time value (secconds)
+    // string variables
+    const float        tension = 10.0;                  // tension along the string (newtons)
+    std::vector<float> mass( numberOfPoints, 1.0 );     // mass of the string (kg) - mass is uniform accross the string
+    std::vector<float> velocity( numberOfPoints, 0.0 ); // velocity of each point
+    std::vector<float> temporaryString = stringVector;  // the next step, swapped with the string every update
+
+    // timing
+    std::chrono::duration<double> computeTime( 0.0 );
+    std::chrono::duration<double> ioTime( 0.0 );
+    long long                     steps = 0;
 
+    outputBuffer output;
+    initialiseOutput( output, data, binaryOutput, numberOfPoints, deltaLength );
+    while( time <= timeLimit ) {
+        if( steps % outputInterval == 0 ) {
+            auto ioStart = std::chrono::steady_clock::now();
+            writeFrame( output, stringVector, time, deltaLength, binaryOutput );
+            ioTime += std::chrono::steady_clock::now() - ioStart;
+        }
+        auto computeStart = std::chrono::steady_clock::now();
+        updateString( stringVector, temporaryString, velocity, mass, tension, deltaLength, deltaTime );
+        computeTime += std::chrono::steady_clock::now() - computeStart;
+        time += deltaTime;
+        steps += 1;
+    }
+    auto ioStart = std::chrono::steady_clock::now();
+    flushOutput( output, true );
     data.close();
+    ioTime += std::chrono::steady_clock::now() - ioStart;
+
+    // throughput
+    const double pointUpdates = static_cast<double>( steps ) * ( numberOfPoints - 2 );
+    std::cout << std::format( "Steps: {}, points: {}\n", steps, numberOfPoints );
+    std::cout << std::format( "Compute: {:.3f}s, {:.3e} point updates/s\n", computeTime.count(), pointUpdates / computeTime.count() );
+    std::cout << std::format( "I/O: {:.3f}s, {:.1f} MB/s\n", ioTime.count(), output.bytesWritten / 1e6 / ioTime.count() );
 
     return EXIT_SUCCESS;
 }
@@ -74,35 +139,77 @@ std::vector<float> createString( const int numberOfPoints, const int mode, const
     return stringVector;
 }
 
-void updateString( std::vector<float> &stringVector, std::ofstream &file, const float deltaLength ) {
-    // time
-    float       deltaTime = 0.1;  // delta time between steps (secconds)
-    float       time      = 0.0;  // time (secconds)
-    const float timeLimit = 50.0; // maximum time value (secconds)
-    // string variables
-    const int          stringPoints = stringVector.size();
-    const float        tension      = 10.0;       // tension along the string (newtons)
-    std::vector<float> mass( stringPoints, 1.0 ); // mass of the string (kg) - mass is uniform accross the string
-    // temporary vectors
-    std::vector<float> velocity( stringPoints, 0.0 );
-    std::vector<float> temporaryString( stringPoints, 0.0 );
-    temporaryString.at( 0 )                = stringVector.at( 0 );
-    temporaryString.at( stringPoints - 1 ) = stringVector.at( stringPoints - 1 );
-
-    file << "t\tx\ty\n";
-    while( time <= timeLimit ) {
-        file << std::format( "{}\t{}\t{}\n", time, 0, stringVector.at( 0 ) );
-        for( int i = 1; i < stringPoints - 1; i++ ) {
-            file << std::format( "{}\t{}\t{}\n", time, i * deltaLength, stringVector.at( i ) );
-            velocity.at( i ) += ( ( tension / mass.at( i ) ) * ( ( stringVector.at( i - 1 ) - 2 * stringVector.at( i ) + stringVector.at( i + 1 ) ) / pow( deltaLength, 2 ) ) ) * deltaTime;
-            temporaryString.at( i ) = stringVector.at( i ) + velocity.at( i ) * deltaTime;
-            if( i > 2 ) {
-                stringVector.at( i - 2 ) = temporaryString.at( i - 2 );
-            }
+void updateString( std::vector<float> &stringVector, std::vector<float> &temporaryString, std::vector<float> &velocity, const std::vector<float> &mass, const float tension, const float deltaLength, const float deltaTime ) {
+    // one step of the fixed end string, no i/o in here so the loop stays tight
+    const int    stringPoints = stringVector.size();
+    const float  coefficient  = tension * deltaTime / ( deltaLength * deltaLength );
+    const float *y            = stringVector.data();
+    float       *v            = velocity.data();
+    float       *next         = temporaryString.data();
+    for( int i = 1; i < stringPoints - 1; i++ ) {
+        v[i] += ( coefficient / mass[i] ) * ( y[i - 1] - 2 * y[i] + y[i + 1] );
+        next[i] = y[i] + v[i] * deltaTime;
+    }
+    std::swap( stringVector, temporaryString ); // end points are the same in both so they stay fixed
+}
+
+void initialiseOutput( outputBuffer &output, std::ofstream &file, const bool binaryOutput, const int numberOfPoints, const float deltaLength ) {
+    output.file         = &file;
+    output.data         = std::vector<char>( 2 * outputBlockSize );
+    output.used         = 0;
+    output.bytesWritten = 0;
+    if( binaryOutput ) {
+        // header: "WOS1", number of points (int32), delta length (float32), then each frame is time followed by every y value (float32)
+        const int32_t points = numberOfPoints;
+        appendBytes( output, "WOS1", 4 );
+        appendBytes( output, &points, sizeof( points ) );
+        appendBytes( output, &deltaLength, sizeof( deltaLength ) );
+    }
+    else {
+        appendBytes( output, "t\tx\ty\n", 6 );
+    }
+}
+
+void writeFrame( outputBuffer &output, const std::vector<float> &stringVector, const float time, const float deltaLength, const bool binaryOutput ) {
+    if( binaryOutput ) {
+        appendBytes( output, &time, sizeof( time ) );
+        appendBytes( output, stringVector.data(), stringVector.size() * sizeof( float ) );
+        return;
+    }
+    // text, each line is at most 3 floats plus separators
+    char      line[64];
+    const int numberOfPoints = static_cast<int>( stringVector.size() );
+    for( int i = 0; i < numberOfPoints; i++ ) {
+        char *end = std::to_chars( line, line + sizeof( line ), time ).ptr;
+        *end++    = '\t';
+        end       = std::to_chars( end, line + sizeof( line ), i * deltaLength ).ptr;
+        *end++    = '\t';
+        end       = std::to_chars( end, line + sizeof( line ), stringVector[i] ).ptr;
+        *end++    = '\n';
+        appendBytes( output, line, end - line );
+    }
+}
+
+void appendBytes( outputBuffer &output, const void *bytes, const std::size_t size ) {
+    const char *source    = static_cast<const char *>( bytes );
+    std::size_t remaining = size;
+    while( remaining > 0 ) {
+        std::size_t chunk = std::min( remaining, output.data.size() - output.used );
+        std::memcpy( output.data.data() + output.used, source, chunk );
+        output.used += chunk;
+        source += chunk;
+        remaining -= chunk;
+        if( output.used >= outputBlockSize ) {
+            flushOutput( output, false );
         }
-        file << std::format( "{}\t{}\t{}\n", time, ( stringPoints - 1 ) * deltaLength, stringVector.at( stringPoints - 1 ) );
-        stringVector.at( stringPoints - 2 ) = temporaryString.at( stringPoints - 2 ); // last 2 points that dont get changed
-        stringVector.at( stringPoints - 3 ) = temporaryString.at( stringPoints - 3 );
-        time += deltaTime;
     }
 }
+
+void flushOutput( outputBuffer &output, const bool final ) {
+    // writes whole blocks, the leftover is moved to the front unless this is the last flush
+    std::size_t size = final ? output.used : ( output.used / outputBlockSize ) * outputBlockSize;
+    output.file->write( output.data.data(), size );
+    output.bytesWritten += size;
+    std::memmove( output.data.data(), output.data.data() + size, output.used - size );
+    output.used -= size;
+}
@@ -13,6 +13,20 @@
 #include <numbers>
 #include <queue>
 
+// vertex streaming
+// ----------------
+
+// glBufferStorage is gl 4.4 / ARB_buffer_storage, so it is loaded by hand rather than relying on the glad profile
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+typedef void( APIENTRYP bufferStorageFunction )( GLenum target, GLsizeiptr size, const void *data, GLbitfield flags );
+
+const int streamRegions = 3; // number of frames the vertex stream can hold at once
+
 // structs
 // -------
 
@@ -22,6 +36,17 @@ struct point
     GLfloat y;
 };
 
+struct streamBuffer // fixed size buffer of string y values split into regions so a new frame never overwrites one the gpu is drawing
+{
+    GLfloat             *mapped;                // persistent mapping of every region, null when falling back to glBufferSubData
+    std::vector<GLfloat> staging;               // cpu copy of a frame for the glBufferSubData fallback
+    GLsync               fences[streamRegions]; // signalled once the gpu has finished drawing each region
+    int                  region;                // region the next frame is written to
+    int                  drawRegion;            // region holding the latest frame
+    int                  numberOfPoints;        // points per region
+    unsigned int         VBO;
+};
+
 struct bufferData
 {
     std::vector<double> string;
@@ -64,9 +89,17 @@ void initialiseGLFW();
 
 void initialiseGLAD();
 
-void initialiseShaders( unsigned int &vertexShader, unsigned int &fragmentShader, unsigned int &shaderProgram, int &colour );
+void initialiseShaders( const char *vertexSource, unsigned int &vertexShader, unsigned int &fragmentShader, unsigned int &shaderProgram, int &colour );
+
+void initialiseVboVao( unsigned int &VBO, unsigned int &VAO, streamBuffer &stream, const int numberOfPoints, unsigned int &shaderProgram );
+
+GLfloat *beginStreamWrite( streamBuffer &stream );
 
-void initialiseVboVao( unsigned int &VBO, unsigned int &VAO, point *graph, unsigned int &shaderProgram );
+void endStreamWrite( streamBuffer &stream );
+
+void fenceStream( streamBuffer &stream );
+
+void convertToFloat( const double *__restrict source, GLfloat *__restrict destination, const int count );
 
 void initialiseAxesVboVao( unsigned int &axesVBO, unsigned int &axesVAO, point *axes, unsigned int &shaderProgram );
 
@@ -74,7 +107,7 @@ void initialiseAxisTicksVboVao( unsigned int &axisTicksVBO, unsigned int &axisTi
 
 void processInput( GLFWwindow *window, float &updateSpeed, bool &saveData );
 
-void rendering( unsigned int &shaderProgram, unsigned int &VAO, unsigned int &axesVAO, unsigned int &axisTicksVAO, const int numberOfPoints, int colourLocation, const int numberOfticks );
+void rendering( unsigned int &shaderProgram, unsigned int &stringShaderProgram, unsigned int &VAO, unsigned int &axesVAO, unsigned int &axisTicksVAO, const int firstPoint, const int numberOfPoints, int colourLocation, int stringColourLocation, int firstPointLocation, const int numberOfticks );
 
 void eventSwap( GLFWwindow *window );
 
@@ -91,6 +124,16 @@ const char *vertexShaderSource =
     "    gl_Position = vec4(aPos.x, aPos.y, aPos.z, 1.0);\n"
     "}\0";
 
+const char *stringVertexShaderSource = 
+    "#version 330 core\n"
+    "layout (location = 0) in float aY;\n"
+    "uniform int numberOfPoints;\n"
+    "uniform int firstPoint;\n"
+    "void main() {\n"
+    "    float x = float(gl_VertexID - firstPoint) / (float(numberOfPoints - 1) / 2.0) - 1.0;\n"
+    "    gl_Position = vec4(x, aY, 0.0, 1.0);\n"
+    "}\0";
+
 const char *fragmentShaderSource = 
     "#version 330 core\n"
     "out vec4 FragColor;\n"
@@ -139,9 +182,6 @@ int main() {
     const int   numberOfPoints = 101; // number of points in the string, can only be odd
     const double height         = 1.0; // amplitude of peaks in the y direction (meters)
 
-    // holds the string data
-    point graph[numberOfPoints];
-
     // holds the axes
     // clang-format off
     point axes[4] = {
@@ -173,7 +213,14 @@ int main() {
     unsigned int fragmentShader;
     unsigned int shaderProgram;
     int          colourLocation;
-    initialiseShaders( vertexShader, fragmentShader, shaderProgram, colourLocation );
+    initialiseShaders( vertexShaderSource, vertexShader, fragmentShader, shaderProgram, colourLocation );
+
+    // initialises the string shader, it only needs the y values
+    unsigned int stringShaderProgram;
+    int          stringColourLocation;
+    initialiseShaders( stringVertexShaderSource, vertexShader, fragmentShader, stringShaderProgram, stringColourLocation );
+    int firstPointLocation = glGetUniformLocation( stringShaderProgram, "firstPoint" );
+    glUniform1i( glGetUniformLocation( stringShaderProgram, "numberOfPoints" ), numberOfPoints );
 
     // initialises axis VBO and VAO
     unsigned int axesVBO;
@@ -192,10 +239,11 @@ int main() {
     callbackData.numberOfTicks       = numberOfTicks;
     glfwSetWindowUserPointer( window, &callbackData );
 
-    // initialises VBO and VAO
+    // initialises VBO and VAO, the string is streamed through a triple buffered VBO
     unsigned int VBO;
     unsigned int VAO;
-    initialiseVboVao( VBO, VAO, graph, shaderProgram );
+    streamBuffer stream;
+    initialiseVboVao( VBO, VAO, stream, numberOfPoints, shaderProgram );
 
     // time variables
     double time        = 0.0; // time (secconds)
@@ -209,6 +257,7 @@ int main() {
     std::vector<double> mass( stringPoints, 1.0 );                            // mass of the string (kg) - mass is uniform accross the string
     const double        deltaLength        = length / ( numberOfPoints - 1 ); // the distance between points (meters)
     const double        dampingCoefficient = 1.0;                             // damping coefficient in the free dispersive string
+    bool stringChanged = true; // the stream only gets a new frame when the string has been updated
     // velocity vector
     std::vector<double> velocity( stringPoints, 0.0 );
 
@@ -247,23 +296,24 @@ int main() {
             // updateFixedString( stringVector, velocity, mass, stringPoints, tension, deltaLength, deltaTime );
             // updateFreeString( stringVector, velocity, mass, stringPoints, tension, deltaLength, deltaTime );
             updateFreeDispersiveString( stringVector, velocity, mass, stringPoints, tension, deltaLength, deltaTime, dampingCoefficient );
-            // copy the data
-            for( int i = 0; i < numberOfPoints; i++ ) {
-                float x    = ( i ) / 50.0;
-                graph[i].x = x - 1;
-                graph[i].y = static_cast<float>(stringVector[i]);
-            }
             time += deltaTime;
+            stringChanged = true;
         }
 
         // precise time
         realTime += frameTime * static_cast<double>(updateSpeed);
         //std::cout << realTime << "\t" << time << std::endl;
 
-        // save data to the buffer
-        glBindBuffer( GL_ARRAY_BUFFER, VBO );
-        glBufferData( GL_ARRAY_BUFFER, numberOfPoints * sizeof( point ), graph, GL_DYNAMIC_DRAW );
-        rendering( shaderProgram, VAO, axesVAO, axisTicksVAO, numberOfPoints, colourLocation, numberOfTicks );
+        // converts the string into the next free region of the stream, only done for frames that are drawn
+        if( stringChanged ) {
+            convertToFloat( stringVector.data(), beginStreamWrite( stream ), numberOfPoints );
+            endStreamWrite( stream );
+            stringChanged = false;
+        }
+
+        // draws the latest frame in the stream
+        rendering( shaderProgram, stringShaderProgram, VAO, axesVAO, axisTicksVAO, stream.drawRegion * numberOfPoints, numberOfPoints, colourLocation, stringColourLocation, firstPointLocation, numberOfTicks );
+        fenceStream( stream );
 
         eventSwap( window );
     }
@@ -447,13 +497,13 @@ void initialiseGLAD() {
     glClearColor( 1.0f, 1.0f, 1.0f, 1.0f );
 }
 
-void initialiseShaders( unsigned int &vertexShader, unsigned int &fragmentShader, unsigned int &shaderProgram, int &colourLocation ) {
+void initialiseShaders( const char *vertexSource, unsigned int &vertexShader, unsigned int &fragmentShader, unsigned int &shaderProgram, int &colourLocation ) {
     // error logging
     int  success;
     char infolog[512];
     // vertex shader
     vertexShader = glCreateShader( GL_VERTEX_SHADER );
-    glShaderSource( vertexShader, 1, &vertexShaderSource, NULL );
+    glShaderSource( vertexShader, 1, &vertexSource, NULL );
     glCompileShader( vertexShader );
 
     glGetShaderiv( vertexShader, GL_COMPILE_STATUS, &success );
@@ -491,19 +541,87 @@ void initialiseShaders( unsigned int &vertexShader, unsigned int &fragmentShader
     colourLocation = glGetUniformLocation( shaderProgram, "colour" );
 }
 
-void initialiseVboVao( unsigned int &VBO, unsigned int &VAO, point *graph, unsigned int &shaderProgram ) {
+void initialiseVboVao( unsigned int &VBO, unsigned int &VAO, streamBuffer &stream, const int numberOfPoints, unsigned int &shaderProgram ) {
     // vbo
     glGenBuffers( 1, &VBO );
     glGenVertexArrays( 1, &VAO );
     glBindVertexArray( VAO );
-    // copy verticies array into a buffer
     glBindBuffer( GL_ARRAY_BUFFER, VBO );
-    glBufferData( GL_ARRAY_BUFFER, sizeof( graph ), graph, GL_STATIC_DRAW );
-    // set vertex attributes pointers
-    glVertexAttribPointer( 0, 2, GL_FLOAT, GL_FALSE, 0, (void *)0 );
+    // fixed size storage for every region, persistently mapped when the driver supports it
+    const GLsizeiptr      size          = streamRegions * numberOfPoints * sizeof( GLfloat );
+    const GLbitfield      flags         = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    bufferStorageFunction bufferStorage = NULL;
+    if( glfwExtensionSupported( "GL_ARB_buffer_storage" ) ) {
+        bufferStorage = reinterpret_cast<bufferStorageFunction>( glfwGetProcAddress( "glBufferStorage" ) );
+    }
+    stream.mapped = NULL;
+    if( bufferStorage != NULL ) {
+        bufferStorage( GL_ARRAY_BUFFER, size, NULL, flags );
+        stream.mapped = static_cast<GLfloat *>( glMapBufferRange( GL_ARRAY_BUFFER, 0, size, flags ) );
+        if( stream.mapped == NULL ) {
+            // immutable storage cant be respecified, so the fallback needs a fresh buffer
+            glDeleteBuffers( 1, &VBO );
+            glGenBuffers( 1, &VBO );
+            glBindBuffer( GL_ARRAY_BUFFER, VBO );
+        }
+    }
+    if( stream.mapped == NULL ) {
+        glBufferData( GL_ARRAY_BUFFER, size, NULL, GL_DYNAMIC_DRAW );
+        stream.staging.assign( numberOfPoints, 0.0f );
+    }
+    // stream state
+    for( int i = 0; i < streamRegions; i++ ) {
+        stream.fences[i] = NULL;
+    }
+    stream.region         = 0;
+    stream.drawRegion     = 0;
+    stream.numberOfPoints = numberOfPoints;
+    stream.VBO            = VBO;
+    // set vertex attributes pointers, only y is stored
+    glVertexAttribPointer( 0, 1, GL_FLOAT, GL_FALSE, 0, (void *)0 );
     glEnableVertexAttribArray( 0 );
 }
 
+GLfloat *beginStreamWrite( streamBuffer &stream ) {
+    // waits for the gpu to finish with the next region, it was last drawn two frames ago so this almost never blocks
+    GLsync &fence = stream.fences[stream.region];
+    if( fence != NULL ) {
+        glClientWaitSync( fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000 );
+        glDeleteSync( fence );
+        fence = NULL;
+    }
+    if( stream.mapped == NULL ) {
+        return stream.staging.data();
+    }
+    return stream.mapped + stream.region * stream.numberOfPoints;
+}
+
+void endStreamWrite( streamBuffer &stream ) {
+    // uploads the frame when the buffer isnt mapped and makes it the one to draw
+    if( stream.mapped == NULL ) {
+        glBindBuffer( GL_ARRAY_BUFFER, stream.VBO );
+        glBufferSubData( GL_ARRAY_BUFFER, stream.region * stream.numberOfPoints * sizeof( GLfloat ), stream.numberOfPoints * sizeof( GLfloat ), stream.staging.data() );
+    }
+    stream.drawRegion = stream.region;
+    stream.region     = ( stream.region + 1 ) % streamRegions;
+}
+
+void fenceStream( streamBuffer &stream ) {
+    // marks where in the command stream the gpu is done with the drawn region
+    GLsync &fence = stream.fences[stream.drawRegion];
+    if( fence != NULL ) {
+        glDeleteSync( fence );
+    }
+    fence = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+}
+
+void convertToFloat( const double *__restrict source, GLfloat *__restrict destination, const int count ) {
+    // plain loop over non aliasing pointers so the compiler turns it into packed double to float conversions
+    for( int i = 0; i < count; i++ ) {
+        destination[i] = static_cast<GLfloat>( source[i] );
+    }
+}
+
 void initialiseAxesVboVao( unsigned int &axesVBO, unsigned int &axesVAO, point *axes, unsigned int &shaderProgram ) {
     // vbo
     glGenBuffers( 1, &axesVBO );
@@ -559,7 +677,7 @@ void processInput( GLFWwindow *window, float &updateSpeed, bool &saveData ) {
     saveKeyWasPressed = saveKeyIsPressed;
 }
 
-void rendering( unsigned int &shaderProgram, unsigned int &VAO, unsigned int &axesVAO, unsigned int &axisTicksVAO, const int numberOfPoints, int colourLocation, const int numberOfticks ) {
+void rendering( unsigned int &shaderProgram, unsigned int &stringShaderProgram, unsigned int &VAO, unsigned int &axesVAO, unsigned int &axisTicksVAO, const int firstPoint, const int numberOfPoints, int colourLocation, int stringColourLocation, int firstPointLocation, const int numberOfticks ) {
     glClear( GL_COLOR_BUFFER_BIT );
     glUseProgram( shaderProgram );
     // axes
@@ -569,11 +687,13 @@ void rendering( unsigned int &shaderProgram, unsigned int &VAO, unsigned int &ax
     glDrawArrays( GL_LINES, 0, 4 );
     glBindVertexArray( axisTicksVAO );
     glDrawArrays( GL_LINES, 0, numberOfticks );
-    // string
-    glUniform3f( colourLocation, 0.0f, 0.0f, 0.0f );
+    // string, x is generated in the shader from the vertex id
+    glUseProgram( stringShaderProgram );
+    glUniform3f( stringColourLocation, 0.0f, 0.0f, 0.0f );
+    glUniform1i( firstPointLocation, firstPoint );
     glLineWidth( 1.3f );
     glBindVertexArray( VAO );
-    glDrawArrays( GL_LINE_STRIP, 0, numberOfPoints );
+    glDrawArrays( GL_LINE_STRIP, firstPoint, numberOfPoints );
 }
 
 void eventSwap( GLFWwindow *window ) {